@@ -10,11 +10,14 @@
 #include <stdio.h>
 #include "audio_i2s.h"
 #include "audio_i2s.pio.h"
+#include "clock_config.h"
 #include "hardware/pio.h"
 #include "hardware/gpio.h"
 #include "hardware/dma.h"
 #include "hardware/irq.h"
 #include "hardware/clocks.h"
+#include "hardware/sync.h"
+#include "hardware/timer.h"
 #include <assert.h>
 
 #if PICO_AUDIO_I2S_MONO_OUTPUT
@@ -29,11 +32,23 @@
 
 struct {
     audio_buffer_t *playing_buffer;
+#if PICO_AUDIO_I2S_CHAINED_DMA
+    audio_buffer_t *channel_buffer[2];  // Buffer loaded in each chained channel, NULL for silence
+    uint8_t dma_channels[2];
+#endif
     uint32_t freq;
     uint8_t pio_sm;
     uint8_t dma_channel;
 } shared_state;
 
+// Written from the DMA IRQ only. Read and reset under xrun_lock, which
+// also keeps out the IRQ when it runs on the other core (core1 engine mode).
+static spin_lock_t *xrun_lock;
+static audio_i2s_xrun_stats_t xrun_stats;
+static bool xrun_primed;         // A real buffer has been played since enabling
+static bool xrun_in_gap;         // Currently streaming silence in place of audio
+static uint32_t xrun_gap_start_us;
+
 audio_format_t pio_i2s_consumer_format;
 audio_buffer_format_t pio_i2s_consumer_buffer_format = {
     .format = &pio_i2s_consumer_format,
@@ -56,6 +71,7 @@ const audio_format_t *audio_i2s_setup(const audio_format_t *intended_audio_forma
 #endif
     uint8_t sm = shared_state.pio_sm = config->pio_sm;
     pio_sm_claim(audio_pio, sm);
+    xrun_lock = spin_lock_instance(spin_lock_claim_unused(true));
 
     const struct pio_program *program =
 #if PICO_AUDIO_I2S_CLOCK_PINS_SWAPPED
@@ -74,6 +90,28 @@ const audio_format_t *audio_i2s_setup(const audio_format_t *intended_audio_forma
 
     shared_state.dma_channel = dma_channel;
 
+#if PICO_AUDIO_I2S_CHAINED_DMA
+    // Each channel triggers the other when it completes, so the PIO never
+    // waits for the IRQ. The IRQ refills the channel that just finished.
+    shared_state.dma_channels[0] = dma_channel;
+    shared_state.dma_channels[1] = (uint8_t) dma_claim_unused_channel(true);
+
+    for (uint i = 0; i < 2; i++) {
+        uint channel = shared_state.dma_channels[i];
+        dma_channel_config dma_config = dma_channel_get_default_config(channel);
+
+        channel_config_set_dreq(&dma_config, DREQ_PIOx_TX0 + sm);
+        channel_config_set_transfer_data_size(&dma_config, i2s_dma_configure_size);
+        channel_config_set_chain_to(&dma_config, shared_state.dma_channels[i ^ 1]);
+        dma_channel_configure(channel,
+                              &dma_config,
+                              &audio_pio->txf[sm],
+                              NULL,
+                              0,
+                              false
+        );
+    }
+#else
     dma_channel_config dma_config = dma_channel_get_default_config(dma_channel);
 
     channel_config_set_dreq(&dma_config, DREQ_PIOx_TX0 + sm);
@@ -85,9 +123,15 @@ const audio_format_t *audio_i2s_setup(const audio_format_t *intended_audio_forma
                           0,
                           false
     );
+#endif
 
     irq_add_shared_handler(DMA_IRQ_0 + PICO_AUDIO_I2S_DMA_IRQ, audio_i2s_dma_irq_handler, PICO_SHARED_IRQ_HANDLER_DEFAULT_ORDER_PRIORITY);
+#if PICO_AUDIO_I2S_CHAINED_DMA
+    dma_irqn_set_channel_enabled(PICO_AUDIO_I2S_DMA_IRQ, shared_state.dma_channels[0], 1);
+    dma_irqn_set_channel_enabled(PICO_AUDIO_I2S_DMA_IRQ, shared_state.dma_channels[1], 1);
+#else
     dma_irqn_set_channel_enabled(PICO_AUDIO_I2S_DMA_IRQ, dma_channel, 1);
+#endif
     return intended_audio_format;
 }
 
@@ -96,7 +140,7 @@ static audio_buffer_pool_t *audio_i2s_consumer;
 static void update_pio_frequency(uint32_t sample_freq) {
     uint32_t system_clock_frequency = clock_get_hz(clk_sys);
     assert(system_clock_frequency < 0x40000000);
-    uint32_t divider = system_clock_frequency * 4 / sample_freq;
+    uint32_t divider = clock_i2s_divider(system_clock_frequency, sample_freq);
     assert(divider < 0x1000000);
     pio_sm_set_clkdiv_int_frac(audio_pio, shared_state.pio_sm, divider >> 8u, divider & 0xffu);
     shared_state.freq = sample_freq;
@@ -231,18 +275,19 @@ bool audio_i2s_connect_extra(audio_buffer_pool_t *producer, bool buffer_on_give,
     return true;
 }
 
-static inline void audio_start_dma_transfer() {
-    assert(!shared_state.playing_buffer);
+// Point an idle channel at the next full buffer, or at silence if there is
+// none, without starting it. Returns the buffer, NULL for silence.
+static inline audio_buffer_t *audio_load_dma_channel(uint dma_channel) {
     audio_buffer_t *ab = take_audio_buffer(audio_i2s_consumer, false);
 
-    shared_state.playing_buffer = ab;
+    dma_channel_config c = dma_get_channel_config(dma_channel);
     if (!ab) {
         static uint32_t zero;
-        dma_channel_config c = dma_get_channel_config(shared_state.dma_channel);
         channel_config_set_read_increment(&c, false);
-        dma_channel_set_config(shared_state.dma_channel, &c, false);
-        dma_channel_transfer_from_buffer_now(shared_state.dma_channel, &zero, PICO_AUDIO_I2S_SILENCE_BUFFER_SAMPLE_LENGTH);
-        return;
+        dma_channel_set_config(dma_channel, &c, false);
+        dma_channel_set_read_addr(dma_channel, &zero, false);
+        dma_channel_set_trans_count(dma_channel, PICO_AUDIO_I2S_SILENCE_BUFFER_SAMPLE_LENGTH, false);
+        return NULL;
     }
     assert(ab->sample_count);
     assert(ab->format->format->format == AUDIO_BUFFER_FORMAT_PCM_S16);
@@ -253,15 +298,88 @@ static inline void audio_start_dma_transfer() {
     assert(ab->format->format->channel_count == 2);
     assert(ab->format->sample_stride == 4);
 #endif
-    dma_channel_config c = dma_get_channel_config(shared_state.dma_channel);
     channel_config_set_read_increment(&c, true);
-    dma_channel_set_config(shared_state.dma_channel, &c, false);
-    dma_channel_transfer_from_buffer_now(shared_state.dma_channel, ab->buffer->bytes, ab->sample_count);
+    dma_channel_set_config(dma_channel, &c, false);
+    dma_channel_set_read_addr(dma_channel, ab->buffer->bytes, false);
+    dma_channel_set_trans_count(dma_channel, ab->sample_count, false);
+    return ab;
+}
+
+static inline void audio_start_dma_transfer() {
+    assert(!shared_state.playing_buffer);
+    shared_state.playing_buffer = audio_load_dma_channel(shared_state.dma_channel);
+    dma_channel_start(shared_state.dma_channel);
+}
+
+// Called from the DMA IRQ right after the next transfer was started (or queued).
+// queued is the buffer it plays, NULL for silence.
+static inline void __time_critical_func(audio_i2s_count_xruns)(const audio_buffer_t *queued) {
+    // The state machine ran out of data before this IRQ restarted the DMA
+    uint32_t stall_mask = 1u << (PIO_FDEBUG_TXSTALL_LSB + shared_state.pio_sm);
+    uint32_t over_mask = 1u << (PIO_FDEBUG_TXOVER_LSB + shared_state.pio_sm);
+    uint32_t fdebug = audio_pio->fdebug & (stall_mask | over_mask);
+    if (fdebug) {
+        audio_pio->fdebug = fdebug;  // Write 1 to clear
+    }
+
+    if (!queued) {
+        // Silence is being streamed. Not an xrun before the first block was played.
+        if (!xrun_primed) {
+            return;
+        }
+        uint32_t now = time_us_32();
+        xrun_stats.underruns++;
+        xrun_stats.last_xrun_us = now;
+        if (!xrun_in_gap) {
+            xrun_in_gap = true;
+            xrun_gap_start_us = now;
+        }
+        return;
+    }
+
+    if (xrun_in_gap) {
+        uint32_t gap = time_us_32() - xrun_gap_start_us;
+        if (gap > xrun_stats.longest_gap_us) {
+            xrun_stats.longest_gap_us = gap;
+        }
+        xrun_in_gap = false;
+    }
+    xrun_primed = true;
+
+    if (fdebug & stall_mask) {
+        xrun_stats.stalls++;
+        xrun_stats.last_xrun_us = time_us_32();
+    }
+    if (fdebug & over_mask) {
+        xrun_stats.overruns++;
+        xrun_stats.last_xrun_us = time_us_32();
+    }
+}
+
+static inline void __time_critical_func(audio_i2s_update_xrun_stats)(const audio_buffer_t *queued) {
+    uint32_t save = spin_lock_blocking(xrun_lock);
+    audio_i2s_count_xruns(queued);
+    spin_unlock(xrun_lock, save);
 }
 
 void __isr __time_critical_func(audio_i2s_dma_irq_handler)() {
 #if PICO_AUDIO_I2S_NOOP
     assert(false);
+#else
+#if PICO_AUDIO_I2S_CHAINED_DMA
+    // The other channel is already playing. The one that completed only
+    // has to give back its buffer and be loaded with the next one.
+    for (uint i = 0; i < 2; i++) {
+        uint dma_channel = shared_state.dma_channels[i];
+        if (dma_irqn_get_channel_status(PICO_AUDIO_I2S_DMA_IRQ, dma_channel)) {
+            dma_irqn_acknowledge_channel(PICO_AUDIO_I2S_DMA_IRQ, dma_channel);
+            if (shared_state.channel_buffer[i]) {
+                give_audio_buffer(audio_i2s_consumer, shared_state.channel_buffer[i]);
+            }
+            shared_state.channel_buffer[i] = audio_load_dma_channel(dma_channel);
+            audio_i2s_update_xrun_stats(shared_state.channel_buffer[i]);
+        }
+    }
 #else
     uint dma_channel = shared_state.dma_channel;
     if (dma_irqn_get_channel_status(PICO_AUDIO_I2S_DMA_IRQ, dma_channel)) {
@@ -273,12 +391,48 @@ void __isr __time_critical_func(audio_i2s_dma_irq_handler)() {
 #endif
         }
         audio_start_dma_transfer();
+        audio_i2s_update_xrun_stats(shared_state.playing_buffer);
     }
 #endif
+#endif
 }
 
 static bool audio_enabled;
 
+#if PICO_AUDIO_I2S_CHAINED_DMA
+static void audio_set_dma_chain(uint i, uint chain_to) {
+    uint dma_channel = shared_state.dma_channels[i];
+    dma_channel_config c = dma_get_channel_config(dma_channel);
+    channel_config_set_chain_to(&c, chain_to);
+    dma_channel_set_config(dma_channel, &c, false);
+}
+
+// Queue the first two buffers (or silence) and start the first channel
+static void audio_start_dma_chain(void) {
+    for (uint i = 0; i < 2; i++) {
+        audio_set_dma_chain(i, shared_state.dma_channels[i ^ 1]);
+        shared_state.channel_buffer[i] = audio_load_dma_channel(shared_state.dma_channels[i]);
+    }
+    dma_channel_start(shared_state.dma_channels[0]);
+}
+
+static void audio_stop_dma_chain(void) {
+    // A channel chained to itself triggers nothing, so the abort sticks
+    for (uint i = 0; i < 2; i++) {
+        audio_set_dma_chain(i, shared_state.dma_channels[i]);
+    }
+    for (uint i = 0; i < 2; i++) {
+        uint dma_channel = shared_state.dma_channels[i];
+        dma_channel_abort(dma_channel);
+        dma_irqn_acknowledge_channel(PICO_AUDIO_I2S_DMA_IRQ, dma_channel);
+        if (shared_state.channel_buffer[i]) {
+            give_audio_buffer(audio_i2s_consumer, shared_state.channel_buffer[i]);
+            shared_state.channel_buffer[i] = NULL;
+        }
+    }
+}
+#endif
+
 void audio_i2s_set_enabled(bool enabled) {
     if (enabled != audio_enabled) {
 #ifndef NDEBUG
@@ -290,12 +444,27 @@ void audio_i2s_set_enabled(bool enabled) {
         irq_set_enabled(DMA_IRQ_0 + PICO_AUDIO_I2S_DMA_IRQ, enabled);
 
         if (enabled) {
+            // Startup silence and stalls while disabled are not xruns
+            uint32_t save = spin_lock_blocking(xrun_lock);
+            xrun_primed = false;
+            xrun_in_gap = false;
+            spin_unlock(xrun_lock, save);
+            audio_pio->fdebug = (1u << (PIO_FDEBUG_TXSTALL_LSB + shared_state.pio_sm)) |
+                                (1u << (PIO_FDEBUG_TXOVER_LSB + shared_state.pio_sm));
+#if PICO_AUDIO_I2S_CHAINED_DMA
+            audio_start_dma_chain();
+#else
             audio_start_dma_transfer();
+#endif
         } else {
+#if PICO_AUDIO_I2S_CHAINED_DMA
+            audio_stop_dma_chain();
+#else
             if (shared_state.playing_buffer) {
                 give_audio_buffer(audio_i2s_consumer, shared_state.playing_buffer);
                 shared_state.playing_buffer = NULL;
             }
+#endif
         }
 
         pio_sm_set_enabled(audio_pio, shared_state.pio_sm, enabled);
@@ -304,6 +473,22 @@ void audio_i2s_set_enabled(bool enabled) {
     }
 }
 
+void audio_i2s_get_xrun_stats(audio_i2s_xrun_stats_t *stats) {
+    uint32_t save = spin_lock_blocking(xrun_lock);
+    *stats = xrun_stats;
+    spin_unlock(xrun_lock, save);
+}
+
+void audio_i2s_reset_xrun_stats(void) {
+    uint32_t save = spin_lock_blocking(xrun_lock);
+    xrun_stats = (audio_i2s_xrun_stats_t){0};
+    if (xrun_in_gap) {
+        // Measure the ongoing gap from now on
+        xrun_gap_start_us = time_us_32();
+    }
+    spin_unlock(xrun_lock, save);
+}
+
 bool audio_i2s_connect_s8(audio_buffer_pool_t *producer) {
     assert(false);
     return false;
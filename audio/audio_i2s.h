@@ -72,13 +72,29 @@ extern "C" {
 #define PICO_AUDIO_I2S_CLOCK_PINS_SWAPPED 0
 #endif
 
+// 1 = two DMA channels chained to each other, the next buffer is already queued
+// when the current one completes and the IRQ only recycles buffers.
+// 0 = a single channel restarted from the IRQ after each buffer.
+#ifndef PICO_AUDIO_I2S_CHAINED_DMA
+#define PICO_AUDIO_I2S_CHAINED_DMA 1
+#endif
+
 typedef struct audio_i2s_config {
     uint8_t data_pin;
     uint8_t clock_pin_base;
-    uint8_t dma_channel;
+    uint8_t dma_channel;        // With PICO_AUDIO_I2S_CHAINED_DMA, an unused second channel is claimed too
     uint8_t pio_sm;
 } audio_i2s_config_t;
 
+// Counters maintained by the DMA IRQ handler
+typedef struct audio_i2s_xrun_stats {
+    uint32_t underruns;         // Silence transfers queued because no audio buffer was ready
+    uint32_t stalls;            // PIO TX FIFO ran dry before the next DMA transfer started (late IRQ)
+    uint32_t overruns;          // PIO TX FIFO was written while full
+    uint32_t last_xrun_us;      // time_us_32() of the most recent xrun of any kind
+    uint32_t longest_gap_us;    // Longest run of back-to-back silence transfers
+} audio_i2s_xrun_stats_t;
+
 const audio_format_t *audio_i2s_setup(const audio_format_t *intended_audio_format,
                                      const audio_i2s_config_t *config);
 
@@ -93,6 +109,11 @@ bool audio_i2s_connect_extra(audio_buffer_pool_t *producer, bool buffer_on_give,
 
 void audio_i2s_set_enabled(bool enabled);
 
+// Take a consistent snapshot of the xrun counters, from either core (takes a spin lock the DMA IRQ also uses)
+void audio_i2s_get_xrun_stats(audio_i2s_xrun_stats_t *stats);
+
+void audio_i2s_reset_xrun_stats(void);
+
 #ifdef __cplusplus
 }
 #endif
@@ -0,0 +1,60 @@
+#ifndef AUDIO_BUS_H_
+#define AUDIO_BUS_H_
+
+/* 32-bit effects bus.
+ * The AMY mix is converted once into Q8.23 (the same scaling as AMY's fixed
+ * point SAMPLE: 1.0 = 1 << 23), the global effects run on that, and a single
+ * saturating stage converts back to int16 for the I2S output. The 8 integer
+ * bits leave room for the effects to overshoot without clipping in between.
+ * Header only, so it also builds on a host machine.
+ */
+
+#include <stdint.h>
+
+#if defined(__ARM_FEATURE_SAT) && __ARM_FEATURE_SAT
+#include <arm_acle.h>
+#endif
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef int32_t bus_sample_t;
+
+#define AUDIO_BUS_FRAC_BITS     23
+#define AUDIO_BUS_ONE           (1 << AUDIO_BUS_FRAC_BITS)
+#define AUDIO_BUS_INT16_SHIFT   (AUDIO_BUS_FRAC_BITS - 15)  // Bits gained over an int16 sample
+
+static inline bus_sample_t audio_bus_from_int16(int16_t sample) {
+    return (bus_sample_t)sample * (1 << AUDIO_BUS_INT16_SHIFT);
+}
+
+// Round to nearest and saturate to the int16 range
+static inline int16_t audio_bus_to_int16(bus_sample_t sample) {
+    int32_t rounded = (sample >> AUDIO_BUS_INT16_SHIFT) + ((sample >> (AUDIO_BUS_INT16_SHIFT - 1)) & 1);
+#if defined(__ARM_FEATURE_SAT) && __ARM_FEATURE_SAT
+    return (int16_t)__ssat(rounded, 16);
+#else
+    if (rounded > INT16_MAX) return INT16_MAX;
+    if (rounded < INT16_MIN) return INT16_MIN;
+    return (int16_t)rounded;
+#endif
+}
+
+static inline void audio_bus_from_int16_block(const int16_t *input, bus_sample_t *output, uint32_t count) {
+    for (uint32_t i = 0; i < count; i++) {
+        output[i] = audio_bus_from_int16(input[i]);
+    }
+}
+
+static inline void audio_bus_to_int16_block(const bus_sample_t *input, int16_t *output, uint32_t count) {
+    for (uint32_t i = 0; i < count; i++) {
+        output[i] = audio_bus_to_int16(input[i]);
+    }
+}
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* AUDIO_BUS_H_ */
@@ -0,0 +1,112 @@
+#include "biquad_fixed.h"
+#include <math.h>
+
+#define BIQUAD_Q_ROUND  ((int64_t)1 << (BIQUAD_Q_FRAC_BITS - 1))
+
+static int32_t coeff_to_q(float value) {
+    float scaled = value * (float)(1 << BIQUAD_Q_FRAC_BITS);
+    if (scaled >= 2147483647.0f) return INT32_MAX;
+    if (scaled <= -2147483648.0f) return INT32_MIN;
+    return (int32_t)lrintf(scaled);
+}
+
+void biquad_q_coeffs_from_float(biquad_q_coeffs_t *q, const float *coeffs) {
+    q->b0 = coeff_to_q(coeffs[0]);
+    q->b1 = coeff_to_q(coeffs[1]);
+    q->b2 = coeff_to_q(coeffs[2]);
+    q->a1 = coeff_to_q(coeffs[3]);
+    q->a2 = coeff_to_q(coeffs[4]);
+}
+
+#define BIQUAD_Q_FRAC_MASK  (((int64_t)1 << BIQUAD_Q_FRAC_BITS) - 1)
+
+// Round the accumulator back to the bus, saturating, and keep what was
+// dropped for the next sample. Shared by both implementations so they
+// round the same way.
+static inline int32_t acc_to_sample(int64_t acc, int32_t *err) {
+    int64_t y = (acc + BIQUAD_Q_ROUND) >> BIQUAD_Q_FRAC_BITS;
+    *err = (int32_t)(((acc + BIQUAD_Q_ROUND) & BIQUAD_Q_FRAC_MASK) - BIQUAD_Q_ROUND);
+    if (y > INT32_MAX) return INT32_MAX;
+    if (y < INT32_MIN) return INT32_MIN;
+    return (int32_t)y;
+}
+
+void biquad_q_process_ref(const biquad_q_coeffs_t *c, biquad_q_state_t *s,
+                          const int32_t *input, int32_t *output, uint32_t frames, uint32_t stride) {
+    for (uint32_t i = 0; i < frames; i++) {
+        int32_t x = input[i * stride];
+        int64_t acc = (int64_t)c->b0 * x
+                    + (int64_t)c->b1 * s->x1
+                    + (int64_t)c->b2 * s->x2
+                    - (int64_t)c->a1 * s->y1
+                    - (int64_t)c->a2 * s->y2
+                    + s->err;
+        int32_t y = acc_to_sample(acc, &s->err);
+        s->x2 = s->x1;
+        s->x1 = x;
+        s->y2 = s->y1;
+        s->y1 = y;
+        output[i * stride] = y;
+    }
+}
+
+// One tap set on locals, so the compiler keeps the whole state in registers
+#define BIQUAD_Q_STEP(x, y, cf, s) do {             \
+        int64_t acc_ = (int64_t)(cf).b0 * (x);       \
+        acc_ += (int64_t)(cf).b1 * (s).x1;           \
+        acc_ += (int64_t)(cf).b2 * (s).x2;           \
+        acc_ -= (int64_t)(cf).a1 * (s).y1;           \
+        acc_ -= (int64_t)(cf).a2 * (s).y2;           \
+        acc_ += (s).err;                             \
+        (y) = acc_to_sample(acc_, &(s).err);         \
+        (s).x2 = (s).x1; (s).x1 = (x);               \
+        (s).y2 = (s).y1; (s).y1 = (y);               \
+    } while (0)
+
+int32_t biquad_q_process_stereo(const biquad_q_coeffs_t c[2], biquad_q_state_t state[2][2],
+                                const int32_t *input, int32_t *output, uint32_t frames,
+                                bool two_stages, int32_t *input_or) {
+    const biquad_q_coeffs_t cl = c[0], cr = c[1];
+    biquad_q_state_t l1 = state[0][0], r1 = state[1][0];
+    biquad_q_state_t l2 = state[0][1], r2 = state[1][1];
+    int32_t any = 0;
+    uint32_t peak = 0;
+
+    // Two loops rather than a test per sample, the stages only differ in count
+    if (!two_stages) {
+        for (uint32_t i = 0; i < frames; i++) {
+            int32_t l = input[2 * i], r = input[2 * i + 1], yl, yr;
+            any |= l | r;
+            BIQUAD_Q_STEP(l, yl, cl, l1);
+            BIQUAD_Q_STEP(r, yr, cr, r1);
+            output[2 * i] = yl;
+            output[2 * i + 1] = yr;
+            uint32_t ml = yl < 0 ? -(uint32_t)yl : (uint32_t)yl;
+            uint32_t mr = yr < 0 ? -(uint32_t)yr : (uint32_t)yr;
+            if (ml > peak) peak = ml;
+            if (mr > peak) peak = mr;
+        }
+    } else {
+        for (uint32_t i = 0; i < frames; i++) {
+            int32_t l = input[2 * i], r = input[2 * i + 1], ml1, mr1, yl, yr;
+            any |= l | r;
+            BIQUAD_Q_STEP(l, ml1, cl, l1);
+            BIQUAD_Q_STEP(ml1, yl, cl, l2);
+            BIQUAD_Q_STEP(r, mr1, cr, r1);
+            BIQUAD_Q_STEP(mr1, yr, cr, r2);
+            output[2 * i] = yl;
+            output[2 * i + 1] = yr;
+            uint32_t ml = yl < 0 ? -(uint32_t)yl : (uint32_t)yl;
+            uint32_t mr = yr < 0 ? -(uint32_t)yr : (uint32_t)yr;
+            if (ml > peak) peak = ml;
+            if (mr > peak) peak = mr;
+        }
+    }
+
+    state[0][0] = l1;
+    state[1][0] = r1;
+    state[0][1] = l2;
+    state[1][1] = r2;
+    *input_or = any;
+    return peak > INT32_MAX ? INT32_MAX : (int32_t)peak;
+}
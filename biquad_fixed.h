@@ -0,0 +1,54 @@
+#ifndef BIQUAD_FIXED_H_
+#define BIQUAD_FIXED_H_
+
+/* Fixed-point biquads for the global filter.
+ * Direct form I on 32-bit bus samples (see audio_bus.h), Q2.29 coefficients,
+ * with every product accumulated at full 64-bit precision. On the Cortex-M33
+ * each tap is a single-cycle SMLAL, and the state stays in integer registers,
+ * with no int/float conversions per sample. The rounding error of each output
+ * is fed back into the next one (first order error feedback), which keeps
+ * low cutoffs, where the poles sit close to the unit circle, from amplifying it.
+ *
+ * biquad_q_process_ref() is the plain C reference: one stage, one channel.
+ * biquad_q_process_stereo() is the kernel the filter runs. It must stay
+ * bit-exact with the reference, which the host harness checks (diapasonix_render -q).
+ */
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define BIQUAD_Q_FRAC_BITS  29  // Coefficients in [-4, 4), a1 reaches -2 at low cutoffs
+
+typedef struct biquad_q_coeffs {
+    int32_t b0, b1, b2, a1, a2;
+} biquad_q_coeffs_t;
+
+typedef struct biquad_q_state {
+    int32_t x1, x2, y1, y2;
+    int32_t err;    // Fraction dropped when rounding the last output
+} biquad_q_state_t;
+
+// From float coefficients in the b0, b1, b2, a1, a2 order (a0 normalised to 1)
+void biquad_q_coeffs_from_float(biquad_q_coeffs_t *q, const float *coeffs);
+
+// One stage on one channel of a block with stride samples per frame.
+// input and output may be the same buffer.
+void biquad_q_process_ref(const biquad_q_coeffs_t *c, biquad_q_state_t *s,
+                          const int32_t *input, int32_t *output, uint32_t frames, uint32_t stride);
+
+// One stage, or the same stage twice (two_stages), on both channels of an
+// interleaved stereo block, in place allowed. state holds [channel][stage].
+// Returns the output peak; *input_or is the OR of all input samples (0 = silent).
+int32_t biquad_q_process_stereo(const biquad_q_coeffs_t c[2], biquad_q_state_t state[2][2],
+                                const int32_t *input, int32_t *output, uint32_t frames,
+                                bool two_stages, int32_t *input_or);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* BIQUAD_FIXED_H_ */
@@ -0,0 +1,49 @@
+#include "clock_config.h"
+#include <stddef.h>
+
+// 230.4 MHz is 75 times 64 x 48 kHz, and divides 32 kHz exactly and the
+// 44.1 kHz family to within 2 ppm, so every rate runs from the same clock.
+// A rate can be given its own PLL settings here if that ever changes.
+static const clock_profile_t clock_profiles[] = {
+    {22050, 1152000000, 5, 1},  // 230.4 MHz, -2 ppm. Half the render load, for battery
+    {32000, 1152000000, 5, 1},  // 230.4 MHz, exact
+    {44100, 1152000000, 5, 1},  // 230.4 MHz, -2 ppm
+    {48000, 1152000000, 5, 1},  // 230.4 MHz, exact with an integer divider (no jitter)
+};
+
+#define NUM_CLOCK_PROFILES (sizeof(clock_profiles) / sizeof(clock_profiles[0]))
+
+const clock_profile_t *clock_profile_for_rate(uint32_t sample_rate) {
+    for (uint8_t i = 0; i < NUM_CLOCK_PROFILES; i++) {
+        if (clock_profiles[i].sample_rate == sample_rate) {
+            return &clock_profiles[i];
+        }
+    }
+    return NULL;
+}
+
+const clock_profile_t *clock_profile_get(uint8_t index) {
+    return (index < NUM_CLOCK_PROFILES) ? &clock_profiles[index] : NULL;
+}
+
+uint8_t clock_profile_count(void) {
+    return NUM_CLOCK_PROFILES;
+}
+
+uint32_t clock_profile_sys_hz(const clock_profile_t *profile) {
+    return profile->vco_freq / (profile->post_div1 * profile->post_div2);
+}
+
+uint32_t clock_i2s_divider(uint32_t sys_hz, uint32_t sample_rate) {
+    // sys_hz / (64 * rate) in 1/256 steps is sys_hz * 4 / rate
+    uint64_t scaled = (uint64_t)sys_hz * (256 / CLOCK_PIO_CYCLES_PER_FRAME);
+    return (uint32_t)((scaled + sample_rate / 2) / sample_rate);
+}
+
+uint64_t clock_i2s_actual_rate_mhz(uint32_t sys_hz, uint32_t divider) {
+    if (divider == 0) {
+        return 0;
+    }
+    uint64_t scaled = (uint64_t)sys_hz * (256 / CLOCK_PIO_CYCLES_PER_FRAME) * 1000;
+    return (scaled + divider / 2) / divider;
+}
@@ -0,0 +1,45 @@
+#ifndef CLOCK_CONFIG_H_
+#define CLOCK_CONFIG_H_
+
+/* System clock and I2S sample rate profiles.
+ * Each supported AUDIO_SAMPLE_RATE comes with the PLL settings it runs at.
+ * The I2S PIO program takes 64 system clock cycles per stereo frame (times
+ * its clock divider), so the rate it actually plays at depends on how well
+ * the system clock divides into it. The divider math has no hardware
+ * dependency and is also built by the host harness (diapasonix_render -c).
+ */
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define CLOCK_XOSC_HZ               12000000    // Crystal, the PLL reference
+#define CLOCK_PIO_CYCLES_PER_FRAME  64          // audio_i2s.pio: 2 instructions per bit, 32 bits per frame
+
+typedef struct clock_profile {
+    uint32_t sample_rate;       // Hz
+    uint32_t vco_freq;          // Hz, a multiple of CLOCK_XOSC_HZ between 750 and 1600 MHz
+    uint8_t post_div1;          // 1-7
+    uint8_t post_div2;          // 1-7, not above post_div1
+} clock_profile_t;
+
+// NULL if the rate is not in the table
+const clock_profile_t *clock_profile_for_rate(uint32_t sample_rate);
+const clock_profile_t *clock_profile_get(uint8_t index);
+uint8_t clock_profile_count(void);
+
+uint32_t clock_profile_sys_hz(const clock_profile_t *profile);
+
+// PIO clock divider in 16.8 fixed point, rounded to the nearest step
+uint32_t clock_i2s_divider(uint32_t sys_hz, uint32_t sample_rate);
+
+// Rate the I2S output runs at with that divider, in mHz
+uint64_t clock_i2s_actual_rate_mhz(uint32_t sys_hz, uint32_t divider);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* CLOCK_CONFIG_H_ */
@@ -17,12 +17,61 @@
 #define MIDI_NOTE_OFF               0x80
 
 /* Clock values */
-#define F_CPU                       225000000
-#define F_CPU_MOD_KHZ               226000
-#define F_SAMP                      44140
-#define VCO_FREQ                    1356000000
-#define PLL_PD1                     6
-#define PLL_PD2                     1
+#define AUDIO_SAMPLE_RATE           44100 // 22050, 32000, 44100 or 48000. The system clock for each
+                                          // rate is in clock_config.c. CMakeLists.txt reads this
+                                          // line and builds AMY at the same rate.
+
+/* Multicore rendering */
+#define RENDER_BALANCE_ENABLED      true // Move the core0/core1 oscillator split to balance render time
+#define RENDER_BALANCE_MIN_DIFF_CYCLES 4000 // Ignore imbalances below this (~17us at 230MHz)
+#define RENDER_CLAIM_TIMEOUT_US     1500 // Core0 renders core1's share itself if core1 hasn't started it by then
+#define RENDER_TIMEOUT_US           5000 // Give up on a core1 render that started but hasn't finished
+// #define RENDER_STATS_PRINT_MS    1000 // Uncomment to print the split, per-core cycles and I2S xruns every second
+#define AUDIO_PIPELINE_DEPTH        1    // Mixed blocks queued for the output stage (global FX into the I2S buffer),
+                                         // which then runs on core1 while both cores render the next block.
+                                         // 0 = lockstep, core0 runs the output stage itself.
+                                         // Each step adds one block of output latency
+                                         // (AMY_BLOCK_SIZE samples, ~5.8ms at 44.1kHz). Depths above 1
+                                         // add no extra overlap, only slack for render time spikes.
+#define AUDIO_LATENCY_LOW_BUFFERS   3    // I2S buffers in use for each latency profile (Settings screen):
+#define AUDIO_LATENCY_BALANCED_BUFFERS 4 // one playing, one queued and one being filled, plus
+#define AUDIO_LATENCY_SAFE_BUFFERS  6    // spares that absorb render time spikes. Each spare adds
+                                         // one block of output latency.
+#define AUDIO_BUFFER_COUNT          (AUDIO_LATENCY_SAFE_BUFFERS + AUDIO_PIPELINE_DEPTH) // I2S buffers allocated,
+                                         // enough for the deepest profile plus those held by the pipeline
+#define AUDIO_SILENCE_THRESHOLD     4    // Peak sample value (of 32767) below which a mixed block counts as silent
+#define AUDIO_IDLE_BLOCKS           16   // Silent blocks (~93ms) with no sounding string before rendering stops
+#define SYNTH_RELEASE_TAIL_MS       2000 // A string counts as sounding for this long after its note off
+#define GLOBAL_FILTER_TAIL_THRESHOLD 2   // Filter state below this many int16 steps (with silent input) is flushed to zero
+#define GLOBAL_FILTER_SMOOTHING     0.25f // Share of a cutoff/Q change applied per block (~95% after 10 blocks, 58ms)
+#define GLOBAL_FILTER_SNAP          0.002f // Relative distance to the target below which the ramp ends
+#define GLOBAL_FILTER_FIXED_POINT   1    // 1 = fixed-point biquads (biquad_fixed.c), 0 = float. Stereo builds only.
+// #define GLOBAL_FILTER_BENCHMARK         // Uncomment to print the cycles per block of both filter kernels at boot
+#define GLOBAL_FILTER_WAH_CONTROL_FRAMES 32 // Auto-wah: frames between two cutoff updates (~0.7ms)
+#define GLOBAL_FILTER_WAH_SENSITIVITY 4.0f  // Auto-wah: output peak (of full scale) giving the full sweep is 1/this
+#define GLOBAL_DISTORTION_LUT_BITS  8    // Distortion curve table: 2^bits segments up to the clip point (1KB, two copies)
+#define STRING_INSERTS_BUDGET_PERCENT 30 // Estimated share of a core's block time the per-string distortion and filter
+                                         // may take before the UI warns, AMY's oscillators need the rest
+#ifndef PROFILER_ENABLED                 // The host harness turns it on from its CMakeLists.txt
+#define PROFILER_ENABLED            0    // Time each stage of the audio block, see profiler.h.
+                                         // The report is printed with the RENDER_STATS_PRINT_MS stats.
+#endif
+#define AUDIO_CORE1_ENGINE          0    // 1 = core1 owns AMY, the global FX and the I2S output on its own,
+                                         // core0 only posts note and settings commands to it.
+                                         // All oscillators then render on core1, and the
+                                         // render split and AUDIO_PIPELINE_DEPTH don't apply.
+#define SYNTH_CMD_QUEUE_SIZE        64   // Commands in flight from core0 to the audio engine (power of 2)
+#define SYNTH_CMD_POST_TIMEOUT_US   2000 // Drop a command if the engine doesn't make room for it by then
+
+/* Main loop scheduler */
+#define TASK_USB_PERIOD_US          1000   // TinyUSB device task (1kHz)
+#define TASK_TOUCH_PERIOD_US        5000   // MPR121 scan and note handling
+#define TASK_BUTTONS_PERIOD_US      5000   // Directional switch polling
+#define TASK_DISPLAY_PERIOD_US      33333  // Caps the display refresh to ~30fps
+#define TASK_FLASH_PERIOD_US        100000 // Check for pending settings writes
+// #define SCHEDULER_STATS_PRINT_MS 2000   // Uncomment to print per-task runs, overruns and worst latency
+// #define DISPLAY_STRESS_TEST             // Uncomment to redraw the display on every refresh task run,
+                                           // to measure audio latency and dropouts under display load
 
 /* Fretboard */
 #define NUM_STRINGS                 4
@@ -45,6 +94,7 @@
 /* AMY synth */
 #define DEFAULT_PATCH              226
 #define DEFAULT_VOLUME             3 // 0-8 range, gets converted to AMY's 0-11.0 range
+#define DEFAULT_LATENCY_PROFILE    LATENCY_LOW
 
 /* String pitch defaults */
 #define DEFAULT_STRING_PITCH_0     55 // G3
@@ -71,12 +121,29 @@
                                                        // the program will crash.
 
 /* Filter defaults */
+#define DIAPASONIX_FILTER_DEFAULT_TYPE         0        // FILTER_TYPE_LPF24
 #define DIAPASONIX_FILTER_DEFAULT_FREQ_HZ      1000.0f  // 1 kHz cutoff
 #define DIAPASONIX_FILTER_DEFAULT_RESONANCE    0.7f     // Default Q factor
+#define DIAPASONIX_FILTER_DEFAULT_WAH_DEPTH    0        // Auto-wah sweep in half octaves, 0 = off
+#define DIAPASONIX_FILTER_DEFAULT_WAH_SPEED    1        // FILTER_WAH_MEDIUM
+#define DIAPASONIX_FILTER_DEFAULT_PER_STRING   0        // 1 = one filter per string, 0 = on the mix
+#define DIAPASONIX_FILTER_WAH_DEPTH_MAX        8        // 4 octaves
+#define DIAPASONIX_FILTER_WAH_FAST_ATTACK_MS   2.0f     // Auto-wah follower times for each speed
+#define DIAPASONIX_FILTER_WAH_FAST_RELEASE_MS  60.0f
+#define DIAPASONIX_FILTER_WAH_MEDIUM_ATTACK_MS 5.0f
+#define DIAPASONIX_FILTER_WAH_MEDIUM_RELEASE_MS 150.0f
+#define DIAPASONIX_FILTER_WAH_SLOW_ATTACK_MS   15.0f
+#define DIAPASONIX_FILTER_WAH_SLOW_RELEASE_MS  400.0f
 
 /* Distortion defaults */
+#define DIAPASONIX_DISTORTION_DEFAULT_MODEL    0        // DISTORTION_MODEL_HARSH
 #define DIAPASONIX_DISTORTION_DEFAULT_LEVEL    0.75f    // 0.0 to 1.0 - amount of distortion
 #define DIAPASONIX_DISTORTION_DEFAULT_GAIN     10.0f    // 10.0 to 20.0 internally (displayed as 1.0 to 2.0 in UI) - drive/gain before distortion
+#define DIAPASONIX_DISTORTION_DEFAULT_OVERSAMPLING 1    // DISTORTION_OVERSAMPLE_2X
+#define DIAPASONIX_DISTORTION_DEFAULT_PER_STRING 0      // 1 = one distortion per string, 0 = on the mix
+
+/* Effects chain defaults */
+#define DIAPASONIX_FX_DEFAULT_ORDER            0        // FX_ORDER_DISTORTION_FILTER: distortion, then filter
 
 /* I2C */
 #define I2C_PORT                    i2c0
@@ -147,6 +214,7 @@
                                         // Reserve the last 4KB of the default 2MB flash for persistence.
 #define MAGIC_NUMBER                {0x44, 0x50, 0x53, 0x58} // 'DPSX' - Diapasonix magic number
 #define MAGIC_NUMBER_LENGTH         4
+#define FLASH_DATA_VERSION          6    // Bump when the stored layout changes, older data is then ignored
 #define FLASH_WRITE_DELAY_S         10  // To minimize flash operations, delay writing by this amount of seconds.
                                         // Unfortunately, the audio output is interrupted for a very short instant 
                                         // during write operations.
@@ -171,10 +239,18 @@
 #define PRESET_0_ECHO_DELAY_MS      DIAPASONIX_ECHO_DEFAULT_DELAY_MS
 #define PRESET_0_ECHO_FEEDBACK      DIAPASONIX_ECHO_DEFAULT_FEEDBACK
 #define PRESET_0_ECHO_FILTER_COEF   DIAPASONIX_ECHO_DEFAULT_FILTER_COEF
+#define PRESET_0_FILTER_TYPE        DIAPASONIX_FILTER_DEFAULT_TYPE
 #define PRESET_0_FILTER_FREQ_HZ     DIAPASONIX_FILTER_DEFAULT_FREQ_HZ
 #define PRESET_0_FILTER_RESONANCE   DIAPASONIX_FILTER_DEFAULT_RESONANCE
+#define PRESET_0_FILTER_WAH_DEPTH   DIAPASONIX_FILTER_DEFAULT_WAH_DEPTH
+#define PRESET_0_FILTER_WAH_SPEED   DIAPASONIX_FILTER_DEFAULT_WAH_SPEED
+#define PRESET_0_FILTER_PER_STRING  DIAPASONIX_FILTER_DEFAULT_PER_STRING
+#define PRESET_0_DISTORTION_MODEL   DIAPASONIX_DISTORTION_DEFAULT_MODEL
 #define PRESET_0_DISTORTION_LEVEL   DIAPASONIX_DISTORTION_DEFAULT_LEVEL
 #define PRESET_0_DISTORTION_GAIN    DIAPASONIX_DISTORTION_DEFAULT_GAIN
+#define PRESET_0_DISTORTION_OVERSAMPLING DIAPASONIX_DISTORTION_DEFAULT_OVERSAMPLING
+#define PRESET_0_DISTORTION_PER_STRING DIAPASONIX_DISTORTION_DEFAULT_PER_STRING
+#define PRESET_0_FX_ORDER          DIAPASONIX_FX_DEFAULT_ORDER
 #define PRESET_0_STRING_PITCH_0     DEFAULT_STRING_PITCH_0
 #define PRESET_0_STRING_PITCH_1     DEFAULT_STRING_PITCH_1
 #define PRESET_0_STRING_PITCH_2     DEFAULT_STRING_PITCH_2
@@ -198,10 +274,18 @@
 #define PRESET_1_ECHO_DELAY_MS      DIAPASONIX_ECHO_DEFAULT_DELAY_MS
 #define PRESET_1_ECHO_FEEDBACK      DIAPASONIX_ECHO_DEFAULT_FEEDBACK
 #define PRESET_1_ECHO_FILTER_COEF   DIAPASONIX_ECHO_DEFAULT_FILTER_COEF
+#define PRESET_1_FILTER_TYPE        DIAPASONIX_FILTER_DEFAULT_TYPE
 #define PRESET_1_FILTER_FREQ_HZ     DIAPASONIX_FILTER_DEFAULT_FREQ_HZ
 #define PRESET_1_FILTER_RESONANCE   DIAPASONIX_FILTER_DEFAULT_RESONANCE
+#define PRESET_1_FILTER_WAH_DEPTH   DIAPASONIX_FILTER_DEFAULT_WAH_DEPTH
+#define PRESET_1_FILTER_WAH_SPEED   DIAPASONIX_FILTER_DEFAULT_WAH_SPEED
+#define PRESET_1_FILTER_PER_STRING  DIAPASONIX_FILTER_DEFAULT_PER_STRING
+#define PRESET_1_DISTORTION_MODEL   DIAPASONIX_DISTORTION_DEFAULT_MODEL
 #define PRESET_1_DISTORTION_LEVEL   DIAPASONIX_DISTORTION_DEFAULT_LEVEL
 #define PRESET_1_DISTORTION_GAIN    DIAPASONIX_DISTORTION_DEFAULT_GAIN
+#define PRESET_1_DISTORTION_OVERSAMPLING DIAPASONIX_DISTORTION_DEFAULT_OVERSAMPLING
+#define PRESET_1_DISTORTION_PER_STRING DIAPASONIX_DISTORTION_DEFAULT_PER_STRING
+#define PRESET_1_FX_ORDER          DIAPASONIX_FX_DEFAULT_ORDER
 #define PRESET_1_STRING_PITCH_0     DEFAULT_STRING_PITCH_0
 #define PRESET_1_STRING_PITCH_1     DEFAULT_STRING_PITCH_1
 #define PRESET_1_STRING_PITCH_2     DEFAULT_STRING_PITCH_2
@@ -225,10 +309,18 @@
 #define PRESET_2_ECHO_DELAY_MS      DIAPASONIX_ECHO_DEFAULT_DELAY_MS
 #define PRESET_2_ECHO_FEEDBACK      DIAPASONIX_ECHO_DEFAULT_FEEDBACK
 #define PRESET_2_ECHO_FILTER_COEF   DIAPASONIX_ECHO_DEFAULT_FILTER_COEF
+#define PRESET_2_FILTER_TYPE        DIAPASONIX_FILTER_DEFAULT_TYPE
 #define PRESET_2_FILTER_FREQ_HZ     DIAPASONIX_FILTER_DEFAULT_FREQ_HZ
 #define PRESET_2_FILTER_RESONANCE   DIAPASONIX_FILTER_DEFAULT_RESONANCE
+#define PRESET_2_FILTER_WAH_DEPTH   DIAPASONIX_FILTER_DEFAULT_WAH_DEPTH
+#define PRESET_2_FILTER_WAH_SPEED   DIAPASONIX_FILTER_DEFAULT_WAH_SPEED
+#define PRESET_2_FILTER_PER_STRING  DIAPASONIX_FILTER_DEFAULT_PER_STRING
+#define PRESET_2_DISTORTION_MODEL   DIAPASONIX_DISTORTION_DEFAULT_MODEL
 #define PRESET_2_DISTORTION_LEVEL   DIAPASONIX_DISTORTION_DEFAULT_LEVEL
 #define PRESET_2_DISTORTION_GAIN    DIAPASONIX_DISTORTION_DEFAULT_GAIN
+#define PRESET_2_DISTORTION_OVERSAMPLING DIAPASONIX_DISTORTION_DEFAULT_OVERSAMPLING
+#define PRESET_2_DISTORTION_PER_STRING DIAPASONIX_DISTORTION_DEFAULT_PER_STRING
+#define PRESET_2_FX_ORDER          DIAPASONIX_FX_DEFAULT_ORDER
 #define PRESET_2_STRING_PITCH_0     DEFAULT_STRING_PITCH_0
 #define PRESET_2_STRING_PITCH_1     DEFAULT_STRING_PITCH_1
 #define PRESET_2_STRING_PITCH_2     DEFAULT_STRING_PITCH_2
@@ -252,10 +344,18 @@
 #define PRESET_3_ECHO_DELAY_MS      DIAPASONIX_ECHO_DEFAULT_DELAY_MS
 #define PRESET_3_ECHO_FEEDBACK      DIAPASONIX_ECHO_DEFAULT_FEEDBACK
 #define PRESET_3_ECHO_FILTER_COEF   DIAPASONIX_ECHO_DEFAULT_FILTER_COEF
+#define PRESET_3_FILTER_TYPE        DIAPASONIX_FILTER_DEFAULT_TYPE
 #define PRESET_3_FILTER_FREQ_HZ     DIAPASONIX_FILTER_DEFAULT_FREQ_HZ
 #define PRESET_3_FILTER_RESONANCE   DIAPASONIX_FILTER_DEFAULT_RESONANCE
+#define PRESET_3_FILTER_WAH_DEPTH   DIAPASONIX_FILTER_DEFAULT_WAH_DEPTH
+#define PRESET_3_FILTER_WAH_SPEED   DIAPASONIX_FILTER_DEFAULT_WAH_SPEED
+#define PRESET_3_FILTER_PER_STRING  DIAPASONIX_FILTER_DEFAULT_PER_STRING
+#define PRESET_3_DISTORTION_MODEL   DIAPASONIX_DISTORTION_DEFAULT_MODEL
 #define PRESET_3_DISTORTION_LEVEL   DIAPASONIX_DISTORTION_DEFAULT_LEVEL
 #define PRESET_3_DISTORTION_GAIN    DIAPASONIX_DISTORTION_DEFAULT_GAIN
+#define PRESET_3_DISTORTION_OVERSAMPLING DIAPASONIX_DISTORTION_DEFAULT_OVERSAMPLING
+#define PRESET_3_DISTORTION_PER_STRING DIAPASONIX_DISTORTION_DEFAULT_PER_STRING
+#define PRESET_3_FX_ORDER          DIAPASONIX_FX_DEFAULT_ORDER
 #define PRESET_3_STRING_PITCH_0     DEFAULT_STRING_PITCH_0
 #define PRESET_3_STRING_PITCH_1     DEFAULT_STRING_PITCH_1
 #define PRESET_3_STRING_PITCH_2     DEFAULT_STRING_PITCH_2
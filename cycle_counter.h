@@ -0,0 +1,51 @@
+#ifndef CYCLE_COUNTER_H_
+#define CYCLE_COUNTER_H_
+
+/* Cheap per-core cycle counter.
+ * On the device each core has its own SysTick, which we run free from the
+ * processor clock as a 24-bit down counter. At 230 MHz it wraps every ~73 ms,
+ * far longer than one audio block, so differences are always valid.
+ * On a host build the counter is backed by a monotonic nanosecond clock.
+ */
+
+#include <stdint.h>
+
+#if PICO_ON_DEVICE
+#include "hardware/structs/systick.h"
+
+#define CYCLE_COUNTER_MASK  0x00FFFFFFu
+#define CYCLE_COUNTER_UNIT  "cycles"
+
+// Must be called once on each core that takes measurements
+static inline void cycle_counter_init(void) {
+    systick_hw->csr = 0;
+    systick_hw->rvr = CYCLE_COUNTER_MASK;
+    systick_hw->cvr = 0;
+    systick_hw->csr = 0x5;  // ENABLE | CLKSOURCE (processor clock), no interrupt
+}
+
+static inline uint32_t cycle_counter_now(void) {
+    // SysTick counts down, invert it so the value increases with time
+    return ~systick_hw->cvr & CYCLE_COUNTER_MASK;
+}
+#else
+#include <time.h>
+
+#define CYCLE_COUNTER_MASK  0xFFFFFFFFu
+#define CYCLE_COUNTER_UNIT  "ns"
+
+static inline void cycle_counter_init(void) {
+}
+
+static inline uint32_t cycle_counter_now(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint32_t)((uint64_t)ts.tv_sec * 1000000000u + (uint64_t)ts.tv_nsec);
+}
+#endif
+
+static inline uint32_t cycle_counter_elapsed(uint32_t start, uint32_t end) {
+    return (end - start) & CYCLE_COUNTER_MASK;
+}
+
+#endif /* CYCLE_COUNTER_H_ */
@@ -4,6 +4,7 @@
 #include "state_data.h"
 #include "display/display.h"
 #include "flash.h"
+#include "multicore_audio.h"
 #include "ssd1306.h"
 
 extern void update_display();
@@ -100,6 +101,11 @@ static inline void ds_left() {
             break;
         case CTX_FILTER:
             switch(selection) {
+                case SELECTION_FILTER_TYPE:
+                    set_filter_type_down();
+                    update_fx(FILTER);
+                    set_draw_pending(true);
+                    break;
                 case SELECTION_FILTER_FREQ:
                     set_filter_freq_hz_down();
                     update_fx(FILTER);
@@ -110,16 +116,38 @@ static inline void ds_left() {
                     update_fx(FILTER);
                     set_draw_pending(true);
                     break;
+                case SELECTION_FILTER_WAH_DEPTH:
+                    set_filter_wah_depth_down();
+                    update_fx(FILTER);
+                    set_draw_pending(true);
+                    break;
+                case SELECTION_FILTER_WAH_SPEED:
+                    set_filter_wah_speed_down();
+                    update_fx(FILTER);
+                    set_draw_pending(true);
+                    break;
             }
             break;
         case CTX_DISTORTION:
             switch(selection) {
                 case SELECTION_DISTORTION_LEVEL:
                     set_distortion_level_down();
+                    update_fx(DISTORTION);
+                    set_draw_pending(true);
+                    break;
+                case SELECTION_DISTORTION_MODEL:
+                    set_distortion_model_down();
+                    update_fx(DISTORTION);
                     set_draw_pending(true);
                     break;
                 case SELECTION_DISTORTION_GAIN:
                     set_distortion_gain_down();
+                    update_fx(DISTORTION);
+                    set_draw_pending(true);
+                    break;
+                case SELECTION_DISTORTION_QUALITY:
+                    set_distortion_oversampling_down();
+                    update_fx(DISTORTION);
                     set_draw_pending(true);
                     break;
             }
@@ -161,6 +189,11 @@ static inline void ds_left() {
                     display_update_contrast(&display);
                     set_draw_pending(true);
                 break;
+                case SELECTION_SETTINGS_LATENCY:
+                    set_latency_profile_down();
+                    audio_set_latency_profile(get_latency_profile());
+                    set_draw_pending(true);
+                break;
             }
             break;
         case CTX_ADVANCED:
@@ -279,6 +312,11 @@ static inline void ds_right() {
             break;
         case CTX_FILTER:
             switch(selection) {
+                case SELECTION_FILTER_TYPE:
+                    set_filter_type_up();
+                    update_fx(FILTER);
+                    set_draw_pending(true);
+                    break;
                 case SELECTION_FILTER_FREQ:
                     set_filter_freq_hz_up();
                     update_fx(FILTER);
@@ -289,16 +327,38 @@ static inline void ds_right() {
                     update_fx(FILTER);
                     set_draw_pending(true);
                     break;
+                case SELECTION_FILTER_WAH_DEPTH:
+                    set_filter_wah_depth_up();
+                    update_fx(FILTER);
+                    set_draw_pending(true);
+                    break;
+                case SELECTION_FILTER_WAH_SPEED:
+                    set_filter_wah_speed_up();
+                    update_fx(FILTER);
+                    set_draw_pending(true);
+                    break;
             }
             break;
         case CTX_DISTORTION:
             switch(selection) {
                 case SELECTION_DISTORTION_LEVEL:
                     set_distortion_level_up();
+                    update_fx(DISTORTION);
+                    set_draw_pending(true);
+                    break;
+                case SELECTION_DISTORTION_MODEL:
+                    set_distortion_model_up();
+                    update_fx(DISTORTION);
                     set_draw_pending(true);
                     break;
                 case SELECTION_DISTORTION_GAIN:
                     set_distortion_gain_up();
+                    update_fx(DISTORTION);
+                    set_draw_pending(true);
+                    break;
+                case SELECTION_DISTORTION_QUALITY:
+                    set_distortion_oversampling_up();
+                    update_fx(DISTORTION);
                     set_draw_pending(true);
                     break;
             }
@@ -340,6 +400,11 @@ static inline void ds_right() {
                     display_update_contrast(&display);
                     set_draw_pending(true);
                 break;
+                case SELECTION_SETTINGS_LATENCY:
+                    set_latency_profile_up();
+                    audio_set_latency_profile(get_latency_profile());
+                    set_draw_pending(true);
+                break;
             }
             break;
         case CTX_ADVANCED:
@@ -429,6 +494,7 @@ static inline void ds_center() {
         break;
         case SELECTION_DISTORTION:
             set_fx(DISTORTION, !get_fx(DISTORTION));
+            update_fx(DISTORTION);
             set_draw_pending(true);
         break;
         case SELECTION_TUNING:
@@ -465,9 +531,7 @@ static inline void ds_center() {
             else if (selection == SELECTION_FILTER_ONOFF) fx = FILTER;
             else fx = DISTORTION;
             set_fx(fx, !get_fx(fx));
-            if (fx != DISTORTION) {
-                update_fx(fx);
-            }
+            update_fx(fx);
             set_draw_pending(true);
         }
         break;
@@ -478,6 +542,21 @@ static inline void ds_center() {
         case SELECTION_SETTINGS_PLAYING_MODE:
            toggle_playing_mode();
         break;
+        case SELECTION_FILTER_PLACEMENT:
+            toggle_filter_per_string();
+            update_fx(FILTER);
+            set_draw_pending(true);
+        break;
+        case SELECTION_DISTORTION_PLACEMENT:
+            toggle_distortion_per_string();
+            update_fx(DISTORTION);
+            set_draw_pending(true);
+        break;
+        case SELECTION_DISTORTION_ORDER:
+            toggle_fx_order();
+            update_fx(DISTORTION);
+            set_draw_pending(true);
+        break;
         case SELECTION_REVERB_RESET:
             reset_reverb_fx();
             update_fx(REVERB);
@@ -500,6 +579,7 @@ static inline void ds_center() {
         break;
         case SELECTION_DISTORTION_RESET:
             reset_distortion_fx();
+            update_fx(DISTORTION);
             set_draw_pending(true);
         break;
         case SELECTION_ADVANCED_RESET:
@@ -13,6 +13,8 @@
 #include "patch_names.h"
 #include "intro.h"
 #include "state_data.h"
+#include "multicore_audio.h"
+#include "string_inserts.h"
 #include "icon_low_batt.h"
 #include "icon_dx7.h"
 #include "icon_juno_6.h"
@@ -341,6 +343,23 @@ static inline void draw_settings_screen(ssd1306_t *p, selection_t selection, con
     }
     capline_y += line_height;
 
+    /* Latency */
+    uint8_t latency = get_latency_profile();
+    const char *latency_names[] = {"Low", "Bal", "Safe"};
+    char latency_str[8];
+    if (latency < LATENCY_PROFILE_COUNT) {
+        if (selection == SELECTION_SETTINGS_LATENCY) {
+            // Show what the profile costs while it is being chosen
+            snprintf(latency_str, sizeof(latency_str), "%lums", (audio_latency_us(latency) + 500) / 1000);
+        } else {
+            snprintf(latency_str, sizeof(latency_str), "%s", latency_names[latency]);
+        }
+    } else {
+        snprintf(latency_str, sizeof(latency_str), "?");
+    }
+    draw_entry_value_string(p, capline_y, str_latency, (selection == SELECTION_SETTINGS_LATENCY), latency_str);
+    capline_y += line_height;
+
     draw_entry(p, capline_y, str_advanced, (selection == SELECTION_SETTINGS_ADVANCED));
     capline_y += line_height;
 
@@ -552,7 +571,7 @@ static inline void draw_echo_screen(ssd1306_t *p, selection_t selection, context
 
 static inline void draw_filter_screen(ssd1306_t *p, selection_t selection, context_t context) {
     uint8_t capline_y = 0;
-    uint8_t line_height = 14;
+    uint8_t line_height = 13;  // One more entry than the other screens
     char value_str[16];
 
     ssd1306_draw_string(p, 2, capline_y, 1, str_filter);
@@ -561,6 +580,12 @@ static inline void draw_filter_screen(ssd1306_t *p, selection_t selection, conte
     draw_entry_ab(p, capline_y, str_off, str_on, (selection == SELECTION_FILTER_ONOFF), get_fx(FILTER));
     capline_y += line_height;
 
+    uint8_t filter_type = get_filter_type();
+    const char *filter_type_names[FILTER_TYPE_COUNT] = {"LP24", "LP12", "HP24", "HP12", "BP24", "BP12", "Ntch24", "Ntch12"};
+    draw_entry_value_string(p, capline_y, str_type, (selection == SELECTION_FILTER_TYPE),
+                            filter_type < FILTER_TYPE_COUNT ? filter_type_names[filter_type] : "?");
+    capline_y += line_height;
+
     float freq_hz = get_filter_freq_hz();
     if (freq_hz >= 1000.0f) {
         snprintf(value_str, sizeof(value_str), "%.1fkHz", freq_hz / 1000.0f);
@@ -575,6 +600,25 @@ static inline void draw_filter_screen(ssd1306_t *p, selection_t selection, conte
     draw_entry_value_string(p, capline_y, str_resonance, (selection == SELECTION_FILTER_RESONANCE), value_str);
     capline_y += line_height;
 
+    uint8_t wah_depth = get_filter_wah_depth();
+    if (wah_depth == 0) {
+        snprintf(value_str, sizeof(value_str), "%s", str_off);
+    } else {
+        snprintf(value_str, sizeof(value_str), "%.1foct", wah_depth * 0.5f);
+    }
+    draw_entry_value_string(p, capline_y, str_wah, (selection == SELECTION_FILTER_WAH_DEPTH), value_str);
+    capline_y += line_height;
+
+    uint8_t wah_speed = get_filter_wah_speed();
+    const char *wah_speed_names[FILTER_WAH_SPEED_COUNT] = {"Fast", "Med", "Slow"};
+    draw_entry_value_string(p, capline_y, str_wah_speed, (selection == SELECTION_FILTER_WAH_SPEED),
+                            wah_speed < FILTER_WAH_SPEED_COUNT ? wah_speed_names[wah_speed] : "?");
+    capline_y += line_height;
+
+    draw_entry_ab(p, capline_y, str_on_mix, string_inserts_over_budget() ? str_per_string_heavy : str_per_string,
+                  (selection == SELECTION_FILTER_PLACEMENT), get_filter_per_string());
+    capline_y += line_height;
+
     draw_entry(p, capline_y, str_reset, (selection == SELECTION_FILTER_RESET));
     capline_y += line_height * 1.5;
 
@@ -584,7 +628,7 @@ static inline void draw_filter_screen(ssd1306_t *p, selection_t selection, conte
 
 static inline void draw_distortion_screen(ssd1306_t *p, selection_t selection, context_t context) {
     uint8_t capline_y = 0;
-    uint8_t line_height = 14;
+    uint8_t line_height = 13;  // One more entry than the other screens
     char value_str[16];
 
     ssd1306_draw_string(p, 2, capline_y, 1, str_distortion);
@@ -593,6 +637,12 @@ static inline void draw_distortion_screen(ssd1306_t *p, selection_t selection, c
     draw_entry_ab(p, capline_y, str_off, str_on, (selection == SELECTION_DISTORTION_ONOFF), get_fx(DISTORTION));
     capline_y += line_height;
 
+    uint8_t model = get_distortion_model();
+    const char *model_names[DISTORTION_MODEL_COUNT] = {"Harsh", "Soft", "Tube", "Fuzz", "Crush"};
+    draw_entry_value_string(p, capline_y, str_model, (selection == SELECTION_DISTORTION_MODEL),
+                            model < DISTORTION_MODEL_COUNT ? model_names[model] : "?");
+    capline_y += line_height;
+
     float level = get_distortion_level();
     snprintf(value_str, sizeof(value_str), "%.2f", level);
     draw_entry_value_string(p, capline_y, str_level, (selection == SELECTION_DISTORTION_LEVEL), value_str);
@@ -604,6 +654,20 @@ static inline void draw_distortion_screen(ssd1306_t *p, selection_t selection, c
     draw_entry_value_string(p, capline_y, str_gain, (selection == SELECTION_DISTORTION_GAIN), value_str);
     capline_y += line_height;
 
+    uint8_t oversampling = get_distortion_oversampling();
+    const char *oversampling_names[DISTORTION_OVERSAMPLE_COUNT] = {"1x", "2x", "4x"};
+    draw_entry_value_string(p, capline_y, str_quality, (selection == SELECTION_DISTORTION_QUALITY),
+                            oversampling < DISTORTION_OVERSAMPLE_COUNT ? oversampling_names[oversampling] : "?");
+    capline_y += line_height;
+
+    draw_entry_ab(p, capline_y, str_on_mix, string_inserts_over_budget() ? str_per_string_heavy : str_per_string,
+                  (selection == SELECTION_DISTORTION_PLACEMENT), get_distortion_per_string());
+    capline_y += line_height;
+
+    draw_entry_ab(p, capline_y, str_pre_filter, str_post_filter,
+                  (selection == SELECTION_DISTORTION_ORDER), get_fx_order() == FX_ORDER_FILTER_DISTORTION);
+    capline_y += line_height;
+
     draw_entry(p, capline_y, str_reset, (selection == SELECTION_DISTORTION_RESET));
     capline_y += line_height * 1.5;
 
@@ -8,11 +8,6 @@
 extern "C" {
 #endif
 
-#define CONTRAST_MIN    0
-#define CONTRAST_MED    1
-#define CONTRAST_MAX    2
-#define CONTRAST_AUTO   3
-
 void display_init(ssd1306_t *p);
 void display_draw(ssd1306_t *p);
 void display_update_rotation(ssd1306_t *p);
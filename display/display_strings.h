@@ -20,6 +20,7 @@ const char *str_info            = "Info";
 const char *str_version         = "v";
 const char *str_volume          = "Volume";
 const char *str_contrast        = "Contrast";
+const char *str_latency         = "Latency";
 const char *str_advanced        = "Advanced";
 const char *str_on              = "On";
 const char *str_off             = "Off";
@@ -35,10 +36,20 @@ const char *str_delay_ms        = "Delay";
 const char *str_feedback        = "Feedbk";
 const char *str_filter_coef     = "Filter";
 const char *str_freq            = "Freq";
+const char *str_type            = "Type";
+const char *str_wah             = "Wah";
+const char *str_wah_speed       = "Wah Spd";
 const char *str_poly_puzzle     = "Infin. -1";
 const char *str_resonance       = "Reson";
 const char *str_level           = "Level";
+const char *str_model           = "Model";
 const char *str_gain            = "Gain";
+const char *str_quality         = "Quality";
+const char *str_on_mix          = "On mix";
+const char *str_per_string      = "Per string";
+const char *str_per_string_heavy = "Per str !";  // Inserts over STRING_INSERTS_BUDGET_PERCENT
+const char *str_pre_filter      = "Pre filt";   // Distortion before the filter
+const char *str_post_filter     = "Post filt";
 const char *str_reset           = "Reset";
 
 // Advanced timing parameter strings
@@ -8,6 +8,7 @@
 #include "multicore_audio.h"
 #include "audio/audio_i2s.h"
 #include "amy.h"
+#include "global_distortion.h"
 #include <string.h>
 
 extern ssd1306_t display;
@@ -64,9 +65,15 @@ static inline int32_t unpack_int32(const uint8_t *buffer) {
 // +  8 (distortion)
 // +  4 (strings)
 // +  2 (capo)
-// +  1 (playing_mode) = 65 bytes
+// +  1 (playing_mode)
+// +  1 (filter type)
+// +  2 (filter auto-wah depth and speed)
+// +  1 (distortion oversampling)
+// +  1 (distortion model)
+// +  2 (filter and distortion placement)
+// +  1 (effects order) = 73 bytes
 
-#define PRESET_SIZE 65
+#define PRESET_SIZE 73
 
 // Offset calculations for preset storage
 #define OFFSET_MAGIC 0
@@ -84,6 +91,7 @@ static inline int32_t unpack_int32(const uint8_t *buffer) {
 #define OFFSET_TIMING_VERY_RECENT (OFFSET_TIMING_STALE_TIMEOUT + 4)  // Timing very recent threshold (4 bytes)
 #define OFFSET_TIMING_POST_STRUM (OFFSET_TIMING_VERY_RECENT + 4)  // Timing post strum threshold (4 bytes)
 #define OFFSET_TIMING_RELEASE_DELAY (OFFSET_TIMING_POST_STRUM + 4)  // Timing release delay (4 bytes)
+#define OFFSET_LATENCY_PROFILE (OFFSET_TIMING_RELEASE_DELAY + 4)  // Output latency profile (0-2)
 
 // Helper function to pack current state into a preset buffer
 static void pack_preset(uint8_t *buffer, uint16_t *offset) {
@@ -144,6 +152,32 @@ static void pack_preset(uint8_t *buffer, uint16_t *offset) {
     // Save playing_mode flag
     buffer[*offset + 0] = get_playing_mode() ? 1 : 0;
     *offset += 1;
+    
+    // Save filter type
+    buffer[*offset + 0] = get_filter_type();
+    *offset += 1;
+    
+    // Save filter auto-wah
+    buffer[*offset + 0] = get_filter_wah_depth();
+    buffer[*offset + 1] = get_filter_wah_speed();
+    *offset += 2;
+    
+    // Save distortion oversampling
+    buffer[*offset + 0] = get_distortion_oversampling();
+    *offset += 1;
+    
+    // Save distortion model
+    buffer[*offset + 0] = get_distortion_model();
+    *offset += 1;
+    
+    // Save filter and distortion placement
+    buffer[*offset + 0] = get_filter_per_string() ? 1 : 0;
+    buffer[*offset + 1] = get_distortion_per_string() ? 1 : 0;
+    *offset += 2;
+    
+    // Save effects order
+    buffer[*offset + 0] = get_fx_order();
+    *offset += 1;
 }
 
 // Helper function to unpack a preset buffer into current state
@@ -206,6 +240,32 @@ static void unpack_preset(const uint8_t *buffer, uint16_t *offset) {
     // Load playing_mode flag
     set_playing_mode(buffer[*offset + 0] != 0);
     *offset += 1;
+    
+    // Load filter type
+    set_filter_type(buffer[*offset + 0]);
+    *offset += 1;
+    
+    // Load filter auto-wah
+    set_filter_wah_depth(buffer[*offset + 0]);
+    set_filter_wah_speed(buffer[*offset + 1]);
+    *offset += 2;
+    
+    // Load distortion oversampling
+    set_distortion_oversampling(buffer[*offset + 0]);
+    *offset += 1;
+    
+    // Load distortion model
+    set_distortion_model(buffer[*offset + 0]);
+    *offset += 1;
+    
+    // Load filter and distortion placement
+    set_filter_per_string(buffer[*offset + 0] != 0);
+    set_distortion_per_string(buffer[*offset + 1] != 0);
+    *offset += 2;
+    
+    // Load effects order
+    set_fx_order(buffer[*offset + 0]);
+    *offset += 1;
 }
 
 // Helper function to load default preset values into current state
@@ -227,10 +287,18 @@ static void load_default_preset_to_state(uint8_t preset_num) {
             set_echo_delay_ms(PRESET_0_ECHO_DELAY_MS);
             set_echo_feedback(PRESET_0_ECHO_FEEDBACK);
             set_echo_filter_coef(PRESET_0_ECHO_FILTER_COEF);
+            set_filter_type(PRESET_0_FILTER_TYPE);
             set_filter_freq_hz(PRESET_0_FILTER_FREQ_HZ);
             set_filter_resonance(PRESET_0_FILTER_RESONANCE);
+            set_filter_wah_depth(PRESET_0_FILTER_WAH_DEPTH);
+            set_filter_wah_speed(PRESET_0_FILTER_WAH_SPEED);
+            set_distortion_model(PRESET_0_DISTORTION_MODEL);
+            set_filter_per_string(PRESET_0_FILTER_PER_STRING);
+            set_distortion_per_string(PRESET_0_DISTORTION_PER_STRING);
+            set_fx_order(PRESET_0_FX_ORDER);
             set_distortion_level(PRESET_0_DISTORTION_LEVEL);
             set_distortion_gain(PRESET_0_DISTORTION_GAIN);
+            set_distortion_oversampling(PRESET_0_DISTORTION_OVERSAMPLING);
             set_string_pitch(0, PRESET_0_STRING_PITCH_0);
             set_string_pitch(1, PRESET_0_STRING_PITCH_1);
             set_string_pitch(2, PRESET_0_STRING_PITCH_2);
@@ -254,10 +322,18 @@ static void load_default_preset_to_state(uint8_t preset_num) {
             set_echo_delay_ms(PRESET_1_ECHO_DELAY_MS);
             set_echo_feedback(PRESET_1_ECHO_FEEDBACK);
             set_echo_filter_coef(PRESET_1_ECHO_FILTER_COEF);
+            set_filter_type(PRESET_1_FILTER_TYPE);
             set_filter_freq_hz(PRESET_1_FILTER_FREQ_HZ);
             set_filter_resonance(PRESET_1_FILTER_RESONANCE);
+            set_filter_wah_depth(PRESET_1_FILTER_WAH_DEPTH);
+            set_filter_wah_speed(PRESET_1_FILTER_WAH_SPEED);
+            set_distortion_model(PRESET_1_DISTORTION_MODEL);
+            set_filter_per_string(PRESET_1_FILTER_PER_STRING);
+            set_distortion_per_string(PRESET_1_DISTORTION_PER_STRING);
+            set_fx_order(PRESET_1_FX_ORDER);
             set_distortion_level(PRESET_1_DISTORTION_LEVEL);
             set_distortion_gain(PRESET_1_DISTORTION_GAIN);
+            set_distortion_oversampling(PRESET_1_DISTORTION_OVERSAMPLING);
             set_string_pitch(0, PRESET_1_STRING_PITCH_0);
             set_string_pitch(1, PRESET_1_STRING_PITCH_1);
             set_string_pitch(2, PRESET_1_STRING_PITCH_2);
@@ -281,10 +357,18 @@ static void load_default_preset_to_state(uint8_t preset_num) {
             set_echo_delay_ms(PRESET_2_ECHO_DELAY_MS);
             set_echo_feedback(PRESET_2_ECHO_FEEDBACK);
             set_echo_filter_coef(PRESET_2_ECHO_FILTER_COEF);
+            set_filter_type(PRESET_2_FILTER_TYPE);
             set_filter_freq_hz(PRESET_2_FILTER_FREQ_HZ);
             set_filter_resonance(PRESET_2_FILTER_RESONANCE);
+            set_filter_wah_depth(PRESET_2_FILTER_WAH_DEPTH);
+            set_filter_wah_speed(PRESET_2_FILTER_WAH_SPEED);
+            set_distortion_model(PRESET_2_DISTORTION_MODEL);
+            set_filter_per_string(PRESET_2_FILTER_PER_STRING);
+            set_distortion_per_string(PRESET_2_DISTORTION_PER_STRING);
+            set_fx_order(PRESET_2_FX_ORDER);
             set_distortion_level(PRESET_2_DISTORTION_LEVEL);
             set_distortion_gain(PRESET_2_DISTORTION_GAIN);
+            set_distortion_oversampling(PRESET_2_DISTORTION_OVERSAMPLING);
             set_string_pitch(0, PRESET_2_STRING_PITCH_0);
             set_string_pitch(1, PRESET_2_STRING_PITCH_1);
             set_string_pitch(2, PRESET_2_STRING_PITCH_2);
@@ -308,10 +392,18 @@ static void load_default_preset_to_state(uint8_t preset_num) {
             set_echo_delay_ms(PRESET_3_ECHO_DELAY_MS);
             set_echo_feedback(PRESET_3_ECHO_FEEDBACK);
             set_echo_filter_coef(PRESET_3_ECHO_FILTER_COEF);
+            set_filter_type(PRESET_3_FILTER_TYPE);
             set_filter_freq_hz(PRESET_3_FILTER_FREQ_HZ);
             set_filter_resonance(PRESET_3_FILTER_RESONANCE);
+            set_filter_wah_depth(PRESET_3_FILTER_WAH_DEPTH);
+            set_filter_wah_speed(PRESET_3_FILTER_WAH_SPEED);
+            set_distortion_model(PRESET_3_DISTORTION_MODEL);
+            set_filter_per_string(PRESET_3_FILTER_PER_STRING);
+            set_distortion_per_string(PRESET_3_DISTORTION_PER_STRING);
+            set_fx_order(PRESET_3_FX_ORDER);
             set_distortion_level(PRESET_3_DISTORTION_LEVEL);
             set_distortion_gain(PRESET_3_DISTORTION_GAIN);
+            set_distortion_oversampling(PRESET_3_DISTORTION_OVERSAMPLING);
             set_string_pitch(0, PRESET_3_STRING_PITCH_0);
             set_string_pitch(1, PRESET_3_STRING_PITCH_1);
             set_string_pitch(2, PRESET_3_STRING_PITCH_2);
@@ -384,6 +476,20 @@ static void pack_default_preset(uint8_t *buffer, uint16_t *offset, uint8_t prese
             *offset += 2;
             buffer[*offset + 0] = PRESET_0_PLAYING_MODE;
             *offset += 1;
+            buffer[*offset + 0] = PRESET_0_FILTER_TYPE;
+            *offset += 1;
+            buffer[*offset + 0] = PRESET_0_FILTER_WAH_DEPTH;
+            buffer[*offset + 1] = PRESET_0_FILTER_WAH_SPEED;
+            *offset += 2;
+            buffer[*offset + 0] = PRESET_0_DISTORTION_OVERSAMPLING;
+            *offset += 1;
+            buffer[*offset + 0] = PRESET_0_DISTORTION_MODEL;
+            *offset += 1;
+            buffer[*offset + 0] = PRESET_0_FILTER_PER_STRING;
+            buffer[*offset + 1] = PRESET_0_DISTORTION_PER_STRING;
+            *offset += 2;
+            buffer[*offset + 0] = PRESET_0_FX_ORDER;
+            *offset += 1;
             break;
         case 1:
             buffer[*offset + 0] = PRESET_1_PATCH;
@@ -429,6 +535,20 @@ static void pack_default_preset(uint8_t *buffer, uint16_t *offset, uint8_t prese
             *offset += 2;
             buffer[*offset + 0] = PRESET_1_PLAYING_MODE;
             *offset += 1;
+            buffer[*offset + 0] = PRESET_1_FILTER_TYPE;
+            *offset += 1;
+            buffer[*offset + 0] = PRESET_1_FILTER_WAH_DEPTH;
+            buffer[*offset + 1] = PRESET_1_FILTER_WAH_SPEED;
+            *offset += 2;
+            buffer[*offset + 0] = PRESET_1_DISTORTION_OVERSAMPLING;
+            *offset += 1;
+            buffer[*offset + 0] = PRESET_1_DISTORTION_MODEL;
+            *offset += 1;
+            buffer[*offset + 0] = PRESET_1_FILTER_PER_STRING;
+            buffer[*offset + 1] = PRESET_1_DISTORTION_PER_STRING;
+            *offset += 2;
+            buffer[*offset + 0] = PRESET_1_FX_ORDER;
+            *offset += 1;
             break;
         case 2:
             buffer[*offset + 0] = PRESET_2_PATCH;
@@ -474,6 +594,20 @@ static void pack_default_preset(uint8_t *buffer, uint16_t *offset, uint8_t prese
             *offset += 2;
             buffer[*offset + 0] = PRESET_2_PLAYING_MODE;
             *offset += 1;
+            buffer[*offset + 0] = PRESET_2_FILTER_TYPE;
+            *offset += 1;
+            buffer[*offset + 0] = PRESET_2_FILTER_WAH_DEPTH;
+            buffer[*offset + 1] = PRESET_2_FILTER_WAH_SPEED;
+            *offset += 2;
+            buffer[*offset + 0] = PRESET_2_DISTORTION_OVERSAMPLING;
+            *offset += 1;
+            buffer[*offset + 0] = PRESET_2_DISTORTION_MODEL;
+            *offset += 1;
+            buffer[*offset + 0] = PRESET_2_FILTER_PER_STRING;
+            buffer[*offset + 1] = PRESET_2_DISTORTION_PER_STRING;
+            *offset += 2;
+            buffer[*offset + 0] = PRESET_2_FX_ORDER;
+            *offset += 1;
             break;
         case 3:
             buffer[*offset + 0] = PRESET_3_PATCH;
@@ -519,23 +653,45 @@ static void pack_default_preset(uint8_t *buffer, uint16_t *offset, uint8_t prese
             *offset += 2;
             buffer[*offset + 0] = PRESET_3_PLAYING_MODE;
             *offset += 1;
+            buffer[*offset + 0] = PRESET_3_FILTER_TYPE;
+            *offset += 1;
+            buffer[*offset + 0] = PRESET_3_FILTER_WAH_DEPTH;
+            buffer[*offset + 1] = PRESET_3_FILTER_WAH_SPEED;
+            *offset += 2;
+            buffer[*offset + 0] = PRESET_3_DISTORTION_OVERSAMPLING;
+            *offset += 1;
+            buffer[*offset + 0] = PRESET_3_DISTORTION_MODEL;
+            *offset += 1;
+            buffer[*offset + 0] = PRESET_3_FILTER_PER_STRING;
+            buffer[*offset + 1] = PRESET_3_DISTORTION_PER_STRING;
+            *offset += 2;
+            buffer[*offset + 0] = PRESET_3_FX_ORDER;
+            *offset += 1;
             break;
     }
 }
 
 #if USE_FLASH_STORAGE
 
-bool load_flash_data(void) {
-    // Read address is different than write address
-    const uint8_t *stored_data = (const uint8_t *) (XIP_BASE + FLASH_TARGET_OFFSET);
-
-    // Validation - check magic number
+// Data written by this firmware: magic number and the current layout version
+static bool flash_data_valid(const uint8_t *stored_data) {
     const uint8_t magic[MAGIC_NUMBER_LENGTH] = MAGIC_NUMBER;
     for (uint8_t i = 0; i < MAGIC_NUMBER_LENGTH; i++) {
         if (stored_data[i] != magic[i]) {
-            return false; // Invalid data
+            return false;
         }
     }
+    return stored_data[OFFSET_VERSION] == FLASH_DATA_VERSION;
+}
+
+bool load_flash_data(void) {
+    // Read address is different than write address
+    const uint8_t *stored_data = (const uint8_t *) (XIP_BASE + FLASH_TARGET_OFFSET);
+
+    // Validation - check magic number and layout version
+    if (!flash_data_valid(stored_data)) {
+        return false; // Invalid data
+    }
     
     // Get current preset index (0-3)
     uint8_t current_preset = stored_data[OFFSET_CURRENT_PRESET];
@@ -591,6 +747,12 @@ bool load_flash_data(void) {
     set_fret_post_strum_threshold_ms(unpack_int32(&stored_data[OFFSET_TIMING_POST_STRUM]));
     set_fret_release_delay_ms(unpack_int32(&stored_data[OFFSET_TIMING_RELEASE_DELAY]));
     
+    // Load latency profile (zero in data written before it existed, which is LATENCY_LOW)
+    if (stored_data[OFFSET_LATENCY_PROFILE] < LATENCY_PROFILE_COUNT) {
+        set_latency_profile(stored_data[OFFSET_LATENCY_PROFILE]);
+        audio_set_latency_profile(get_latency_profile());
+    }
+    
     return true;
 }
 
@@ -607,13 +769,10 @@ int64_t flash_write_alarm_callback(alarm_id_t id, void *user_data) {
 // Get current preset index from flash
 static uint8_t get_current_preset_index(void) {
     const uint8_t *stored_data = (const uint8_t *) (XIP_BASE + FLASH_TARGET_OFFSET);
-    const uint8_t magic[MAGIC_NUMBER_LENGTH] = MAGIC_NUMBER;
     
-    // Check magic number
-    for (uint8_t i = 0; i < MAGIC_NUMBER_LENGTH; i++) {
-        if (stored_data[i] != magic[i]) {
-            return 0; // Default to preset 0 if invalid
-        }
+    // Check magic number and layout version
+    if (!flash_data_valid(stored_data)) {
+        return 0; // Default to preset 0 if invalid
     }
     
     uint8_t preset = stored_data[OFFSET_CURRENT_PRESET];
@@ -639,13 +798,7 @@ void flash_write_task(void) {
     
     // Initialize buffer with existing data or zeros
     const uint8_t magic[MAGIC_NUMBER_LENGTH] = MAGIC_NUMBER;
-    bool has_valid_data = true;
-    for (uint8_t i = 0; i < MAGIC_NUMBER_LENGTH; i++) {
-        if (stored_data[i] != magic[i]) {
-            has_valid_data = false;
-            break;
-        }
-    }
+    bool has_valid_data = flash_data_valid(stored_data);
     
     if (has_valid_data) {
         // Copy existing flash data (copy up to sector size, but we only use first few bytes)
@@ -657,7 +810,7 @@ void flash_write_task(void) {
         for (uint8_t i = 0; i < MAGIC_NUMBER_LENGTH; i++) {
             flash_buffer[i] = magic[i];
         }
-        flash_buffer[OFFSET_VERSION] = 0xFF;
+        flash_buffer[OFFSET_VERSION] = FLASH_DATA_VERSION;
         flash_buffer[OFFSET_CURRENT_PRESET] = 0;
         
         // Initialize all presets with defaults
@@ -683,9 +836,10 @@ void flash_write_task(void) {
         pack_int32(&flash_buffer[OFFSET_TIMING_VERY_RECENT], get_fret_very_recent_threshold_ms());
         pack_int32(&flash_buffer[OFFSET_TIMING_POST_STRUM], get_fret_post_strum_threshold_ms());
         pack_int32(&flash_buffer[OFFSET_TIMING_RELEASE_DELAY], get_fret_release_delay_ms());
+        flash_buffer[OFFSET_LATENCY_PROFILE] = get_latency_profile();
         
         // Fill rest with zeros. Possibly unnecessary.
-        uint16_t fill_offset = OFFSET_TIMING_RELEASE_DELAY + 4;
+        uint16_t fill_offset = OFFSET_LATENCY_PROFILE + 1;
         while (fill_offset < FLASH_SECTOR_SIZE) {
             flash_buffer[fill_offset++] = 0;
         }
@@ -723,10 +877,11 @@ void flash_write_task(void) {
     pack_int32(&flash_buffer[OFFSET_TIMING_VERY_RECENT], get_fret_very_recent_threshold_ms());
     pack_int32(&flash_buffer[OFFSET_TIMING_POST_STRUM], get_fret_post_strum_threshold_ms());
     pack_int32(&flash_buffer[OFFSET_TIMING_RELEASE_DELAY], get_fret_release_delay_ms());
+    flash_buffer[OFFSET_LATENCY_PROFILE] = get_latency_profile();
     
     // Check if data has changed (only check the part we use, ~350 bytes + global settings)
     bool data_changed = false;
-    uint16_t data_size = OFFSET_TIMING_RELEASE_DELAY + 4; // Size of all presets + header + global settings
+    uint16_t data_size = OFFSET_LATENCY_PROFILE + 1; // Size of all presets + header + global settings
     for (uint16_t i = 0; i < data_size; i++) {
         if (stored_data[i] != flash_buffer[i]) {
             data_changed = true;
@@ -754,8 +909,10 @@ void flash_write_task(void) {
     // Wait a bit to ensure audio is stopped and we're not in the middle of an audio buffer fill
     sleep_ms(20);
     
-    // Stop audio and synth processes on core1
+    // Stop audio and synth processes on core1, between two blocks
+    audio_core1_park();
     multicore_reset_core1();
+    global_distortion_reset_readers();
     
     // Small delay to ensure Core1 reset completes before flash operations
     sleep_ms(10);
@@ -828,12 +985,9 @@ void load_preset(uint8_t preset_num) {
     
     const uint8_t *stored_data = (const uint8_t *) (XIP_BASE + FLASH_TARGET_OFFSET);
     
-    // Validate magic number
-    const uint8_t magic[MAGIC_NUMBER_LENGTH] = MAGIC_NUMBER;
-    for (uint8_t i = 0; i < MAGIC_NUMBER_LENGTH; i++) {
-        if (stored_data[i] != magic[i]) {
-            return; // Invalid data
-        }
+    // Validate magic number and layout version
+    if (!flash_data_valid(stored_data)) {
+        return; // Invalid data
     }
     
     // Calculate preset offset
@@ -0,0 +1,114 @@
+#include "fx_chain.h"
+#include <assert.h>
+#include "state_data.h"
+#include "global_distortion.h"
+#include "global_filter.h"
+
+// The filter's per-string instances don't depend on the core
+static SAMPLE filter_process_string(uint8_t string, uint8_t core,
+                                    const bus_sample_t *input, bus_sample_t *output, uint16_t frames) {
+    (void)core;
+    return global_filter_process_string(string, input, output, frames);
+}
+
+#define NODE_DISTORTION     0
+#define NODE_FILTER         1
+#define NODE_COUNT          2
+
+static const fx_node_t nodes[NODE_COUNT] = {
+    [NODE_DISTORTION] = {
+        .name = "distortion",
+        .stage = PROFILE_STAGE_DISTORTION,
+        .in_place = true,
+        .is_active = global_distortion_is_active,
+        .is_per_string = global_distortion_is_per_string,
+        .process = global_distortion_process,
+        .process_string = global_distortion_process_string,
+    },
+    [NODE_FILTER] = {
+        .name = "filter",
+        .stage = PROFILE_STAGE_FILTER,
+        .in_place = true,
+        .is_active = global_filter_is_active,
+        .is_per_string = global_filter_is_per_string,
+        .process = global_filter_process,
+        .process_string = filter_process_string,
+    },
+};
+
+static const uint8_t orders[FX_ORDER_COUNT][NODE_COUNT] = {
+    [FX_ORDER_DISTORTION_FILTER] = {NODE_DISTORTION, NODE_FILTER},
+    [FX_ORDER_FILTER_DISTORTION] = {NODE_FILTER, NODE_DISTORTION},
+};
+
+// Written by the UI, read once per block by the runners
+static volatile uint8_t order = FX_ORDER_DISTORTION_FILTER;
+
+void fx_chain_set_order(uint8_t value) {
+    if (value >= FX_ORDER_COUNT) value = FX_ORDER_DISTORTION_FILTER;
+    order = value;
+}
+
+uint8_t fx_chain_get_order(void) {
+    return order;
+}
+
+const fx_node_t *fx_chain_node(uint8_t position) {
+    if (position >= NODE_COUNT) {
+        return NULL;
+    }
+    return &nodes[orders[order][position]];
+}
+
+static inline bool on_mix(const fx_node_t *node) {
+    return node->is_active() && !node->is_per_string();
+}
+
+static inline bool on_strings(const fx_node_t *node) {
+    return node->is_active() && node->is_per_string();
+}
+
+bool fx_chain_mix_active(void) {
+    for (uint8_t n = 0; n < NODE_COUNT; n++) {
+        if (on_mix(&nodes[n])) {
+            return true;
+        }
+    }
+    return false;
+}
+
+bool fx_chain_strings_active(void) {
+    for (uint8_t n = 0; n < NODE_COUNT; n++) {
+        if (on_strings(&nodes[n])) {
+            return true;
+        }
+    }
+    return false;
+}
+
+void fx_chain_process_mix(bus_sample_t *block, uint16_t frames) {
+    const uint8_t *sequence = orders[order];
+    for (uint8_t n = 0; n < NODE_COUNT; n++) {
+        const fx_node_t *node = &nodes[sequence[n]];
+        if (!on_mix(node)) {
+            continue;
+        }
+        // Both runners pass the block as input and output, a node that needs
+        // a separate output has to bring its own buffer first
+        assert(node->in_place);
+        uint32_t start = profiler_start();
+        node->process(block, block, frames);
+        profiler_stop(node->stage, start);
+    }
+}
+
+void fx_chain_process_string(uint8_t string, uint8_t core, bus_sample_t *block, uint16_t frames) {
+    const uint8_t *sequence = orders[order];
+    for (uint8_t n = 0; n < NODE_COUNT; n++) {
+        const fx_node_t *node = &nodes[sequence[n]];
+        if (on_strings(node)) {
+            assert(node->in_place);
+            node->process_string(string, core, block, block, frames);
+        }
+    }
+}
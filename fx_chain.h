@@ -0,0 +1,60 @@
+#ifndef FX_CHAIN_H_
+#define FX_CHAIN_H_
+
+/* Effects chain: the global processors that run after AMY's render, on the
+ * 32-bit bus (see audio_bus.h). Reverb, chorus and echo stay inside AMY.
+ * Each processor is a node that declares whether it can run in place, and
+ * whether it is active and where it is placed (on the mix or per string).
+ * The runners only take nodes that run in place.
+ * The order of the nodes is one of FX_ORDER_* (state_data.h), chosen per
+ * preset. Bypassed nodes are skipped without a call, and with no node
+ * active on the mix the block never leaves int16.
+ * The mix runner records each node's cycles in its profiler stage.
+ */
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "amy.h"
+#include "audio_bus.h"
+#include "profiler.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef struct fx_node {
+    const char *name;
+    profile_stage_t stage;          // Where the mix runner records its cycles
+    bool in_place;                  // Can run with output == input, required by the runners
+    bool (*is_active)(void);        // False: bypassed, skipped entirely
+    bool (*is_per_string)(void);    // Runs on each string instead of the mix
+    SAMPLE (*process)(const bus_sample_t *input, bus_sample_t *output, uint16_t frames);
+    // Per-string instances run in place, in the string's own block
+    SAMPLE (*process_string)(uint8_t string, uint8_t core,
+                             const bus_sample_t *input, bus_sample_t *output, uint16_t frames);
+} fx_node_t;
+
+// Select the order of the nodes (FX_ORDER_*). Takes effect at the next block.
+void fx_chain_set_order(uint8_t order);
+uint8_t fx_chain_get_order(void);
+
+// Node at position (0 = first) in the current order, NULL past the end
+const fx_node_t *fx_chain_node(uint8_t position);
+
+// True if a node has work to do on the mix, or on each string
+bool fx_chain_mix_active(void);
+bool fx_chain_strings_active(void);
+
+// Run the active mix nodes in order on interleaved bus samples, in place.
+// Called by one core at a time.
+void fx_chain_process_mix(bus_sample_t *block, uint16_t frames);
+
+// Run the active per-string nodes in order on the block of one string, in
+// place. core is the core running it, both may run strings at the same time.
+void fx_chain_process_string(uint8_t string, uint8_t core, bus_sample_t *block, uint16_t frames);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* FX_CHAIN_H_ */
@@ -1,7 +1,9 @@
 #include "global_distortion.h"
 #include "state_data.h"
+#include "halfband.h"
 #include <math.h>
 #include <string.h>
+#include <stdatomic.h>
 
 #ifndef M_PI
     #define M_PI 3.14159265358979323846
@@ -10,10 +12,97 @@
 // Distortion state
 static struct {
     bool enabled;
+    uint8_t model; // DISTORTION_MODEL_*
     float level;  // 0.0 to 1.0 - amount of distortion
     float gain;   // 10.0 to 20.0 internally (displayed as 1.0 to 2.0 in UI) - drive/gain before distortion
 } distortion_state;
 
+// Model curves. The gain range is shared, each model scales it to its own drive.
+#define SOFT_DRIVE      0.2f    // Soft: cubic soft clip, gain 10-20 drives it 2-4x
+#define TUBE_DRIVE      0.25f   // Tube: the same soft clip, biased for even harmonics
+#define TUBE_BIAS       0.3f
+#define FUZZ_DRIVE      4.0f    // Fuzz: hard clip of a hot signal, lower on the negative side
+#define FUZZ_NEGATIVE   0.6f
+#define CRUSH_MAX_BITS  12      // Crush: gain 10-20 goes from 12 to 4 bits,
+#define CRUSH_MIN_BITS  4
+#define CRUSH_MAX_HOLD  8       // and from every sample to one in 8 held
+
+// The curve models keep the distorted half of the mix as a table, rebuilt when
+// the model, level or gain change. Each curve only bends the signal up to its
+// clip points (a few percent of full scale at these gains) and is flat beyond,
+// so the table spans just that range and the clean half is a plain multiply.
+// Crush has no table, it has its own kernel. Two copies: blocks read the
+// active one while config_global_distortion() fills the other, then the
+// active index is swapped. Each copy counts the blocks reading it, and a
+// copy is only refilled once the blocks that started on it before the last
+// swap are done. The kernel is picked from the model once per block.
+#define LUT_SEGMENTS    (1 << GLOBAL_DISTORTION_LUT_BITS)
+#define LUT_POS_BITS    16  // Fraction bits of the table position
+#define LUT_RECIP_BITS  16  // Extra bits of the bus-to-position scale
+
+typedef struct distortion_lut {
+    uint8_t model;                      // DISTORTION_MODEL_* this copy was built for
+    int32_t table[LUT_SEGMENTS + 1];    // Level-weighted distorted signal, bus units, over [edge_low, edge_high]
+    int32_t edge_low;                   // Clip points in bus units, the curve is flat beyond them
+    int32_t edge_high;
+    int32_t recip;                      // Bus units to table position, scaled by 2^(LUT_POS_BITS + LUT_RECIP_BITS)
+    int32_t clean_q30;                  // Clean share (1 - level) in Q30
+    int32_t level_q30;                  // Crush: distorted share in Q30
+    int32_t crush_mask;                 // Crush: keeps the bits left
+    uint8_t crush_hold;                 // Crush: samples each value is held for
+} distortion_lut_t;
+
+// Cost model, for the UI to tell whether the string inserts fit in a block.
+// Cycles per stereo frame of one instance on the M33, counted from the inner
+// loops of each kernel (about 15 cycles per table lookup, 4 per tap pair),
+// not measured. Only their ratio to the block budget matters.
+#define CYCLES_PER_FRAME_1X     30
+#define CYCLES_PER_FRAME_2X     330
+#define CYCLES_PER_FRAME_4X     650
+#define CYCLES_PER_FRAME_CRUSH  24
+
+static distortion_lut_t luts[2];
+static _Atomic uint8_t lut_active;          // Copy new blocks read
+static _Atomic uint8_t lut_readers[2];      // Blocks reading each copy right now
+
+// Oversampling. The setting is written by the UI side and picked up by the
+// next block, which clears the filters when it changed.
+static volatile uint8_t oversampling_requested;
+
+// Placement: on the mix, or one insert per string. Every change is counted,
+// an instance clears its state when it sees a new count.
+static volatile bool per_string;
+static volatile uint8_t placement_changes;
+
+// Running state of the distortion on the mix, or on one string. The settings
+// and the table are shared, so the inserts only cost their own filters and hold.
+typedef struct distortion_instance {
+    uint8_t oversampling;       // Factor the filters below run at
+    uint8_t placement;          // placement_changes when the state was cleared
+    struct {
+        halfband_state_t up1, up2, down2, down1;
+    } oversampling_state[AMY_NCHANS];
+    struct {                    // Crush sample and hold
+        bus_sample_t held;
+        uint8_t count;
+    } crush_state[AMY_NCHANS];
+} distortion_instance_t;
+
+static distortion_instance_t mix_instance;
+static distortion_instance_t string_instances[NUM_STRINGS];
+
+// Oversampled signal, a chunk at a time. The mix has its own buffers, the
+// string inserts one set per core since both cores may run them at once.
+#define OVERSAMPLING_CHUNK_FRAMES   64
+
+typedef struct oversampling_scratch {
+    bus_sample_t x2[OVERSAMPLING_CHUNK_FRAMES * 2];
+    bus_sample_t x4[OVERSAMPLING_CHUNK_FRAMES * 4];
+} oversampling_scratch_t;
+
+static oversampling_scratch_t mix_scratch;
+static oversampling_scratch_t string_scratch[2];
+
 // Hard clipping with asymmetric character
 static inline float hard_clip(float x, float threshold) {
     if (x > threshold) return threshold;
@@ -37,13 +126,163 @@ static inline float harsh_waveshape(float x) {
     return sign * shaped;
 }
 
+// Peak of the original (harsh) model, the other curves are scaled to it so
+// that changing the model changes the character, not the loudness
+static inline float harsh_peak(float drive) {
+    float clip_threshold = 1.0f / (1.0f + (drive - 1.0f) * 0.5f);
+    float volume_compensation = 1.0f / (1.0f + (drive - 1.0f) * 0.4f);
+    return clip_threshold * volume_compensation;
+}
+
+// x - x^3/3, flat at +-2/3 from |x| = 1
+static inline float soft_clip(float x) {
+    if (x > 1.0f) return 2.0f / 3.0f;
+    if (x < -1.0f) return -2.0f / 3.0f;
+    return x - x * x * x / 3.0f;
+}
+
+// Driven, shaped, clipped and compensated signal for one clean sample (full scale = 1.0)
+static float distortion_shape(uint8_t model, float clean, float drive) {
+    switch (model) {
+        case DISTORTION_MODEL_SOFT:
+            return soft_clip(clean * drive * SOFT_DRIVE) * 1.5f * harsh_peak(drive);
+        case DISTORTION_MODEL_TUBE: {
+            // The bias is taken out again, silence stays silent
+            float shaped = soft_clip(clean * drive * TUBE_DRIVE + TUBE_BIAS) - soft_clip(TUBE_BIAS);
+            return shaped / (2.0f / 3.0f + soft_clip(TUBE_BIAS)) * harsh_peak(drive);
+        }
+        case DISTORTION_MODEL_FUZZ: {
+            float driven = clean * drive * FUZZ_DRIVE;
+            if (driven > 1.0f) driven = 1.0f;
+            if (driven < -FUZZ_NEGATIVE) driven = -FUZZ_NEGATIVE;
+            return driven * harsh_peak(drive);
+        }
+        default:
+            break;
+    }
+
+    // Gain controls drive amount (how hard we push the signal)
+    float driven = clean * drive;
+    
+    float waveshaped = harsh_waveshape(driven);
+    
+    // Apply hard clipping for even harsher character
+    // Clipping threshold decreases as gain increases for more aggressive sound
+    float clip_threshold = 1.0f / (1.0f + (drive - 1.0f) * 0.5f);
+    float distorted = hard_clip(waveshaped, clip_threshold);
+    
+    // Normalize to maintain approximately constant volume
+    // The waveshaping and clipping reduce volume, so we compensate
+    float volume_compensation = 1.0f / (1.0f + (drive - 1.0f) * 0.4f);
+    return distorted * volume_compensation;
+}
+
+// Input range where a curve model bends, full scale = 1.0
+static void distortion_edges(uint8_t model, float drive, float *low, float *high) {
+    switch (model) {
+        case DISTORTION_MODEL_SOFT:
+            *high = 1.0f / (drive * SOFT_DRIVE);
+            *low = -*high;
+            break;
+        case DISTORTION_MODEL_TUBE:
+            *high = (1.0f - TUBE_BIAS) / (drive * TUBE_DRIVE);
+            *low = (-1.0f - TUBE_BIAS) / (drive * TUBE_DRIVE);
+            break;
+        case DISTORTION_MODEL_FUZZ:
+            *high = 1.0f / (drive * FUZZ_DRIVE);
+            *low = -FUZZ_NEGATIVE / (drive * FUZZ_DRIVE);
+            break;
+        default: {
+            // |x|^3 reaches the clip threshold at the cube root of it
+            float clip_threshold = 1.0f / (1.0f + (drive - 1.0f) * 0.5f);
+            *high = cbrtf(clip_threshold) / drive;
+            *low = -*high;
+            break;
+        }
+    }
+    if (*high > 1.0f) *high = 1.0f;
+    if (*low < -1.0f) *low = -1.0f;
+}
+
+// Mark the active copy in use for a block. The count goes up before the copy
+// is checked to still be the active one, so a rebuild either sees this block
+// as a reader or this block sees the swap and moves to the new copy.
+static uint8_t lut_acquire(void) {
+    for (;;) {
+        uint8_t index = atomic_load(&lut_active);
+        atomic_fetch_add(&lut_readers[index], 1);
+        if (atomic_load(&lut_active) == index) {
+            return index;
+        }
+        atomic_fetch_sub(&lut_readers[index], 1);
+    }
+}
+
+static void lut_release(uint8_t index) {
+    atomic_fetch_sub_explicit(&lut_readers[index], 1, memory_order_release);
+}
+
+void global_distortion_reset_readers(void) {
+    atomic_store(&lut_readers[0], 0);
+    atomic_store(&lut_readers[1], 0);
+}
+
+// Sample the curve between its clip points into the table not in use, then
+// publish it. Called from one side only (init, then apply_fx()). Waits for
+// blocks still reading the copy from before the last swap, at most a block.
+static void lut_rebuild(void) {
+    uint8_t index = atomic_load(&lut_active) ^ 1;
+    while (atomic_load_explicit(&lut_readers[index], memory_order_acquire) != 0) {
+        // A block that started before the last swap is still on this copy
+    }
+    distortion_lut_t *lut = &luts[index];
+    uint8_t model = distortion_state.model;
+    float drive = distortion_state.gain;
+    float level = distortion_state.level;
+
+    lut->model = model;
+    lut->clean_q30 = (int32_t)lrint((1.0 - level) * (1 << 30));
+    lut->level_q30 = (int32_t)lrint(level * (1 << 30));
+    if (model == DISTORTION_MODEL_CRUSH) {
+        float amount = (drive - 10.0f) / 10.0f;
+        int32_t bits = CRUSH_MAX_BITS - (int32_t)lrintf(amount * (CRUSH_MAX_BITS - CRUSH_MIN_BITS));
+        lut->crush_mask = ~((1 << (AUDIO_BUS_FRAC_BITS + 1 - bits)) - 1);
+        lut->crush_hold = (uint8_t)(1 + lrintf(amount * (CRUSH_MAX_HOLD - 1)));
+        atomic_store(&lut_active, index);
+        return;
+    }
+
+    float low, high;
+    distortion_edges(model, drive, &low, &high);
+    lut->edge_low = (int32_t)lrintf(low * (float)AUDIO_BUS_ONE);
+    lut->edge_high = (int32_t)lrintf(high * (float)AUDIO_BUS_ONE);
+    low = (float)lut->edge_low / (float)AUDIO_BUS_ONE;
+    high = (float)lut->edge_high / (float)AUDIO_BUS_ONE;
+    lut->recip = (int32_t)lrint((double)LUT_SEGMENTS * (1 << LUT_POS_BITS) * (1 << LUT_RECIP_BITS) /
+                                (lut->edge_high - lut->edge_low));
+
+    for (int32_t i = 0; i <= LUT_SEGMENTS; i++) {
+        float clean = low + (high - low) * (float)i / (float)LUT_SEGMENTS;
+        lut->table[i] = (int32_t)lrintf(distortion_shape(model, clean, drive) * level * (float)AUDIO_BUS_ONE);
+    }
+    atomic_store(&lut_active, index);
+}
+
 void global_distortion_init(void) {
     distortion_state.enabled = false;
+    distortion_state.model = DISTORTION_MODEL_HARSH;
     distortion_state.level = 0.0f;
     distortion_state.gain = 1.0f;
+    lut_rebuild();
+    oversampling_requested = DISTORTION_OVERSAMPLE_OFF;
+    per_string = false;
+    memset(&mix_instance, 0, sizeof(mix_instance));
+    memset(string_instances, 0, sizeof(string_instances));
 }
 
-void config_global_distortion(float level, float gain) {
+void config_global_distortion(uint8_t model, float level, float gain) {
+    if (model >= DISTORTION_MODEL_COUNT) model = DISTORTION_MODEL_HARSH;
+    
     // Clamp level to 0.0-1.0
     if (level < 0.0f) level = 0.0f;
     if (level > 1.0f) level = 1.0f;
@@ -52,64 +291,224 @@ void config_global_distortion(float level, float gain) {
     if (gain < 10.0f) gain = 10.0f;
     if (gain > 20.0f) gain = 20.0f;
     
+    if (model == distortion_state.model && level == distortion_state.level && gain == distortion_state.gain) {
+        return;
+    }
+    distortion_state.model = model;
     distortion_state.level = level;
     distortion_state.gain = gain;
+    lut_rebuild();
 }
 
 void global_distortion_set_enabled(bool enabled) {
     distortion_state.enabled = enabled;
 }
 
-SAMPLE global_distortion_process(int16_t *buffer, uint16_t length) {
-    // Check if distortion is enabled and level > 0
-    if (!distortion_state.enabled || distortion_state.level <= 0.0f) {
+void global_distortion_set_oversampling(uint8_t oversampling) {
+    if (oversampling >= DISTORTION_OVERSAMPLE_COUNT) oversampling = DISTORTION_OVERSAMPLE_OFF;
+    oversampling_requested = oversampling;
+}
+
+void global_distortion_set_per_string(bool enabled) {
+    if (enabled != per_string) {
+        per_string = enabled;
+        placement_changes++;
+    }
+}
+
+bool global_distortion_is_per_string(void) {
+    return per_string;
+}
+
+bool global_distortion_is_active(void) {
+    return distortion_state.enabled && distortion_state.level > 0.0f;
+}
+
+uint32_t global_distortion_cycles_estimate(void) {
+    if (!global_distortion_is_active()) {
         return 0;
     }
+    static const uint16_t cycles_per_frame[DISTORTION_OVERSAMPLE_COUNT] = {
+        CYCLES_PER_FRAME_1X, CYCLES_PER_FRAME_2X, CYCLES_PER_FRAME_4X
+    };
+    uint8_t oversampling = oversampling_requested;
+    if (distortion_state.model == DISTORTION_MODEL_CRUSH) {
+        return CYCLES_PER_FRAME_CRUSH * AMY_BLOCK_SIZE;
+    }
+    return (uint32_t)cycles_per_frame[oversampling < DISTORTION_OVERSAMPLE_COUNT ? oversampling : 0] * AMY_BLOCK_SIZE;
+}
+
+// Clean share plus the interpolated distorted share
+static inline bus_sample_t lut_lookup(const distortion_lut_t *lut, bus_sample_t x) {
+    int32_t clean = (int32_t)(((int64_t)x * lut->clean_q30) >> 30);
+    if (x >= lut->edge_high) {
+        return clean + lut->table[LUT_SEGMENTS];
+    }
+    if (x <= lut->edge_low) {
+        return clean + lut->table[0];
+    }
+    uint32_t pos = (uint32_t)(((int64_t)(x - lut->edge_low) * lut->recip) >> LUT_RECIP_BITS);
+    uint32_t index = pos >> LUT_POS_BITS;
+    if (index >= LUT_SEGMENTS) {
+        return clean + lut->table[LUT_SEGMENTS];  // Rounding right at the edge
+    }
+    int32_t frac = (int32_t)(pos & ((1u << LUT_POS_BITS) - 1));
+    int32_t y0 = lut->table[index];
+    int32_t y1 = lut->table[index + 1];
+    return clean + y0 + (int32_t)(((int64_t)(y1 - y0) * frac) >> LUT_POS_BITS);
+}
+
+// Crush: bit depth reduction, then sample and hold. The hold counter runs
+// through a select, not a branch.
+static void process_crush(distortion_instance_t *inst, const distortion_lut_t *lut, uint8_t channel,
+                          const bus_sample_t *input, bus_sample_t *output, uint16_t length) {
+    bus_sample_t held = inst->crush_state[channel].held;
+    uint32_t count = inst->crush_state[channel].count;
+    const uint32_t hold = lut->crush_hold;
+    const int32_t half_step = (int32_t)((uint32_t)~lut->crush_mask >> 1);
+    for (uint16_t i = 0; i < length; i++) {
+        bus_sample_t x = input[i * AMY_NCHANS + channel];
+        bus_sample_t crushed = (x + half_step) & lut->crush_mask;
+        held = (count == 0) ? crushed : held;
+        count = (count + 1 == hold) ? 0 : count + 1;
+        output[i * AMY_NCHANS + channel] = (int32_t)(((int64_t)x * lut->clean_q30) >> 30) +
+                                           (int32_t)(((int64_t)held * lut->level_q30) >> 30);
+    }
+    inst->crush_state[channel].held = held;
+    inst->crush_state[channel].count = (uint8_t)count;
+}
+
+static void shape_block(const distortion_lut_t *lut, bus_sample_t *samples, uint32_t count) {
+    for (uint32_t i = 0; i < count; i++) {
+        samples[i] = lut_lookup(lut, samples[i]);
+    }
+}
+
+// One channel through up-sampling, the waveshaper and down-sampling,
+// a chunk of frames at a time
+static void process_oversampled(distortion_instance_t *inst, oversampling_scratch_t *scratch,
+                                const distortion_lut_t *lut, uint8_t oversampling, uint8_t channel,
+                                const bus_sample_t *input, bus_sample_t *output, uint16_t length) {
+    for (uint16_t offset = 0; offset < length; offset += OVERSAMPLING_CHUNK_FRAMES) {
+        uint16_t frames = length - offset;
+        if (frames > OVERSAMPLING_CHUNK_FRAMES) frames = OVERSAMPLING_CHUNK_FRAMES;
+        const bus_sample_t *in = input + offset * AMY_NCHANS + channel;
+        bus_sample_t *out = output + offset * AMY_NCHANS + channel;
+
+        halfband_upsample(&halfband_stage1, &inst->oversampling_state[channel].up1,
+                          in, AMY_NCHANS, scratch->x2, frames);
+        if (oversampling == DISTORTION_OVERSAMPLE_4X) {
+            halfband_upsample(&halfband_stage2, &inst->oversampling_state[channel].up2,
+                              scratch->x2, 1, scratch->x4, 2 * frames);
+            shape_block(lut, scratch->x4, 4 * frames);
+            halfband_downsample(&halfband_stage2, &inst->oversampling_state[channel].down2,
+                                scratch->x4, scratch->x2, 1, 2 * frames);
+        } else {
+            shape_block(lut, scratch->x2, 2 * frames);
+        }
+        halfband_downsample(&halfband_stage1, &inst->oversampling_state[channel].down1,
+                            scratch->x2, out, AMY_NCHANS, frames);
+    }
+}
+
+static SAMPLE process_lut(distortion_instance_t *inst, oversampling_scratch_t *scratch, const distortion_lut_t *lut,
+                          const bus_sample_t *input, bus_sample_t *output, uint16_t length) {
+    // Crush is meant to alias, it always runs at the sample rate
+    uint8_t oversampling = (lut->model == DISTORTION_MODEL_CRUSH) ? DISTORTION_OVERSAMPLE_OFF : oversampling_requested;
+    uint8_t placement = placement_changes;
+    if (oversampling != inst->oversampling || placement != inst->placement) {
+        // Nothing left over from another rate, or from before the instance was last used
+        memset(inst, 0, sizeof(*inst));
+        inst->oversampling = oversampling;
+        inst->placement = placement;
+    }
 
+    // Integer only: no silence skip needed, a lookup costs about as much as the test.
+    // No clipping here either, the output stage saturates once.
     SAMPLE max_val = 0;
-    const float SAMPLE_MAX_F = 32767.0f;
-    const float SAMPLE_MIN_F = -32768.0f;
+    if (lut->model == DISTORTION_MODEL_CRUSH) {
+        for (uint8_t c = 0; c < AMY_NCHANS; c++) {
+            process_crush(inst, lut, c, input, output, length);
+        }
+    } else if (oversampling == DISTORTION_OVERSAMPLE_OFF) {
+        for (uint16_t i = 0; i < length * AMY_NCHANS; i++) {
+            bus_sample_t out_sample = lut_lookup(lut, input[i]);
+            output[i] = out_sample;
+            
+            // Track max value
+            SAMPLE abs_val = (out_sample < 0) ? -out_sample : out_sample;
+            if (abs_val > max_val) max_val = abs_val;
+        }
+        return max_val;
+    } else {
+        for (uint8_t c = 0; c < AMY_NCHANS; c++) {
+            process_oversampled(inst, scratch, lut, oversampling, c, input, output, length);
+        }
+    }
+    for (uint16_t i = 0; i < length * AMY_NCHANS; i++) {
+        SAMPLE abs_val = (output[i] < 0) ? -output[i] : output[i];
+        if (abs_val > max_val) max_val = abs_val;
+    }
     
-    // Process each sample in the interleaved buffer
+    return max_val;
+}
+
+// The table stays the same for the whole block
+static SAMPLE process_instance(distortion_instance_t *inst, oversampling_scratch_t *scratch,
+                               const bus_sample_t *input, bus_sample_t *output, uint16_t length) {
+    uint8_t index = lut_acquire();
+    SAMPLE max_val = process_lut(inst, scratch, &luts[index], input, output, length);
+    lut_release(index);
+    return max_val;
+}
+
+static SAMPLE bypass(const bus_sample_t *input, bus_sample_t *output, uint16_t length) {
+    if (output != input) {
+        memcpy(output, input, length * AMY_NCHANS * sizeof(bus_sample_t));
+    }
+    return 0;
+}
+
+SAMPLE global_distortion_process(const bus_sample_t *input, bus_sample_t *output, uint16_t length) {
+    // Check if distortion is enabled and level > 0, and runs on the mix
+    if (!global_distortion_is_active() || per_string) {
+        return bypass(input, output, length);
+    }
+    return process_instance(&mix_instance, &mix_scratch, input, output, length);
+}
+
+SAMPLE global_distortion_process_string(uint8_t string, uint8_t core,
+                                        const bus_sample_t *input, bus_sample_t *output, uint16_t length) {
+    if (!global_distortion_is_active() || !per_string || string >= NUM_STRINGS) {
+        return bypass(input, output, length);
+    }
+    return process_instance(&string_instances[string], &string_scratch[core & 1], input, output, length);
+}
+
+// The float implementation the table is built from, sample by sample.
+// Kept as the reference for the host harness (diapasonix_render -d).
+SAMPLE global_distortion_process_reference(const bus_sample_t *input, bus_sample_t *output, uint16_t length) {
+    if (distortion_state.model == DISTORTION_MODEL_CRUSH) {
+        return global_distortion_process(input, output, length);  // No table, nothing else to compare with
+    }
+    if (!global_distortion_is_active()) {
+        return bypass(input, output, length);
+    }
+
+    SAMPLE max_val = 0;
+    const float BUS_ONE_F = (float)AUDIO_BUS_ONE;
+    const float BUS_SCALE_F = 1.0f / BUS_ONE_F;
     for (uint16_t i = 0; i < length * AMY_NCHANS; i++) {
-        // Convert int16 to float (-1.0 to 1.0 range)
-        float clean = (float)buffer[i] / SAMPLE_MAX_F;
-        
-        // Gain controls drive amount (how hard we push the signal)
-        // Level controls mix between clean and distorted (0.0 = clean, 1.0 = fully distorted)
-        float drive = distortion_state.gain;
-        
-        float driven = clean * drive;
-        
-        float waveshaped = harsh_waveshape(driven);
-        
-        // Apply hard clipping for even harsher character
-        // Clipping threshold decreases as gain increases for more aggressive sound
-        float clip_threshold = 1.0f / (1.0f + (drive - 1.0f) * 0.5f);
-        float distorted = hard_clip(waveshaped, clip_threshold);
-        
-        // Normalize to maintain approximately constant volume
-        // The waveshaping and clipping reduce volume, so we compensate
-        float volume_compensation = 1.0f / (1.0f + (drive - 1.0f) * 0.4f);
-        float normalized_distorted = distorted * volume_compensation;
-        
+        float clean = (float)input[i] * BUS_SCALE_F;
         // Mix clean and distorted based on level
         // level = 0.0: all clean, level = 1.0: all distorted
-        float output_f = clean * (1.0f - distortion_state.level) + normalized_distorted * distortion_state.level;
-        
-        // Convert back to int16 range
-        float output = output_f * SAMPLE_MAX_F;
-        
-        // Hard clip to prevent overflow
-        if (output > SAMPLE_MAX_F) output = SAMPLE_MAX_F;
-        if (output < SAMPLE_MIN_F) output = SAMPLE_MIN_F;
-        
-        buffer[i] = (int16_t)output;
-        
-        // Track max value
-        int16_t abs_val = (output < 0) ? -output : output;
+        float output_f = clean * (1.0f - distortion_state.level) +
+                         distortion_shape(distortion_state.model, clean, distortion_state.gain) * distortion_state.level;
+        bus_sample_t out_sample = (bus_sample_t)(output_f * BUS_ONE_F);
+        output[i] = out_sample;
+        SAMPLE abs_val = (out_sample < 0) ? -out_sample : out_sample;
         if (abs_val > max_val) max_val = abs_val;
     }
     
     return max_val;
-}
\ No newline at end of file
+}
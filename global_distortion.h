@@ -2,6 +2,7 @@
 #define GLOBAL_DISTORTION_H_
 
 #include "amy.h"
+#include "audio_bus.h"
 
 #ifdef __cplusplus
 extern "C" {
@@ -11,16 +12,50 @@ extern "C" {
 void global_distortion_init(void);
 
 // Configure global distortion
+// model: DISTORTION_MODEL_* (harsh, soft, tube, fuzz or crush)
 // level: 0.0 to 1.0 (amount of distortion effect)
-// gain: 1.0 to 5.0+ (drive/gain before distortion)
-void config_global_distortion(float level, float gain);
+// gain: 10.0 to 20.0 (drive/gain before distortion, or how hard crush reduces)
+void config_global_distortion(uint8_t model, float level, float gain);
+
+// Core1 was reset, maybe in the middle of a block: forget the table copy it
+// was reading, or the next rebuild would wait for it forever. Only call it
+// while no block runs on either core.
+void global_distortion_reset_readers(void);
 
 // Enable/disable global distortion
 void global_distortion_set_enabled(bool enabled);
 
-// Process audio buffer through global distortion
+// Run the waveshaper at 1x, 2x or 4x the sample rate (DISTORTION_OVERSAMPLE_*),
+// to keep the harmonics it adds above Nyquist from folding back as aliases
+void global_distortion_set_oversampling(uint8_t oversampling);
+
+// Run on each string before the mix (one insert per string) instead of on the mix
+void global_distortion_set_per_string(bool enabled);
+bool global_distortion_is_per_string(void);
+
+// True if processing would change the signal (enabled and level > 0)
+bool global_distortion_is_active(void);
+
+// Estimated cycles one instance takes per block with the current settings,
+// 0 when inactive
+uint32_t global_distortion_cycles_estimate(void);
+
+// Process interleaved bus samples from input to output (may be the same buffer).
+// When inactive, input is copied to output unchanged.
+// Only runs when placed on the mix.
 // Returns max sample value after distortion
-SAMPLE global_distortion_process(int16_t *buffer, uint16_t length);
+SAMPLE global_distortion_process(const bus_sample_t *input, bus_sample_t *output, uint16_t length);
+
+// Same for the insert of one string, only when placed per string. Each
+// string keeps its own state. core is the core running it (0 or 1), both
+// may run inserts at the same time.
+SAMPLE global_distortion_process_string(uint8_t string, uint8_t core,
+                                        const bus_sample_t *input, bus_sample_t *output, uint16_t length);
+
+// Same as global_distortion_process() without oversampling, computed in float
+// sample by sample instead of from the table. Reference for tests, too slow
+// for the audio path. Crush has no table and runs its usual kernel.
+SAMPLE global_distortion_process_reference(const bus_sample_t *input, bus_sample_t *output, uint16_t length);
 
 #ifdef __cplusplus
 }
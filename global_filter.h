@@ -2,6 +2,8 @@
 #define GLOBAL_FILTER_H_
 
 #include "amy.h"
+#include "audio_bus.h"
+#include "biquad_fixed.h"
 
 #ifdef __cplusplus
 extern "C" {
@@ -9,20 +11,44 @@ extern "C" {
 
 // Global filter state structure
 typedef struct global_filter_state {
-    SAMPLE filter_delay[8];  // Filter delay line (FILT_NUM_DELAYS * 2 = 4 * 2 = 8)
-    int last_filt_norm_bits;
-    float filter_freq_hz;    // Filter cutoff frequency in Hz
-    float filter_resonance;  // Filter Q factor
-    bool enabled;
+    float filter_delay[4];   // Float kernel: transposed direct form II state, 2 per biquad stage
+    biquad_q_state_t fixed_delay[2]; // Fixed-point kernel: direct form I state, per biquad stage
+    float filter_freq_hz;    // Target cutoff frequency in Hz
+    float filter_resonance;  // Target Q factor
+    uint8_t filter_type;     // FILTER_TYPE_* (state_data.h), applied without ramping
+    float current_freq_hz;   // Cutoff the coefficients were computed for, ramps to the target
+    float current_resonance; // Q the coefficients were computed for, ramps to the target
+    float coeffs_octaves;    // Envelope sweep the coefficients were computed for
+    float coeffs[5];         // Cached coefficients: b0, b1, b2, a1, a2
+    biquad_q_coeffs_t coeffs_q; // The same in fixed point
+    bool coeffs_valid;       // False until coeffs match the current cutoff, Q and type
 } global_filter_state_t;
 
 void global_filter_init(void);
-void config_global_filter(float freq_hz, float resonance); // LPF24 only
+// RBJ cookbook coefficients (b0, b1, b2, a1, a2) for a FILTER_TYPE_* at f = cutoff / sample rate
+void global_filter_gen_coeffs(float *coeffs, uint8_t type, float f, float q);
+void config_global_filter(uint8_t type, float freq_hz, float resonance);
+// Auto-wah: the output level sweeps the cutoff up by up to depth_octaves (0 = off)
+void config_global_filter_envelope(float depth_octaves, float attack_ms, float release_ms);
 void global_filter_set_enabled(bool enabled);
-
-// Process audio buffer through global filter
+bool global_filter_is_active(void);
+// Run on each string before the mix (one insert per string) instead of on the mix
+void global_filter_set_per_string(bool enabled);
+bool global_filter_is_per_string(void);
+// Estimated cycles one instance takes per block with the current settings, 0 when disabled
+uint32_t global_filter_cycles_estimate(void);
+// Measured time per block (cycle_counter.h units) of the float or fixed-point
+// kernel on a 24 dB low pass, 0 if that kernel isn't built
+uint32_t global_filter_benchmark(bool fixed_point);
+
+// Process interleaved bus samples from input to output (may be the same buffer).
+// When disabled, or placed per string, input is copied to output unchanged.
 // Returns max sample value after filtering
-SAMPLE global_filter_process(int16_t *buffer, uint16_t length);
+SAMPLE global_filter_process(const bus_sample_t *input, bus_sample_t *output, uint16_t length);
+
+// Same for the insert of one string, only when placed per string. Each string
+// has its own state and auto-wah envelope.
+SAMPLE global_filter_process_string(uint8_t string, const bus_sample_t *input, bus_sample_t *output, uint16_t length);
 
 #ifdef __cplusplus
 }
@@ -0,0 +1,95 @@
+#include "halfband.h"
+#include <string.h>
+
+// Kaiser windowed sinc, beta 7.5. DC gain is within 0.002 dB of 1.
+static const int32_t stage1_coeffs[12] = {
+    339717075, -107859572, 58656847, -36063644, 22852868, -14347353,
+    8708374, -5004359, 2658460, -1260727, 500148, -139742
+};
+
+static const int32_t stage2_coeffs[4] = {
+    323578716, -68558603, 15013076, -1500443
+};
+
+const halfband_t halfband_stage1 = {stage1_coeffs, 12};
+const halfband_t halfband_stage2 = {stage2_coeffs, 4};
+
+static inline int32_t saturate_sample(int64_t value) {
+    if (value > INT32_MAX) return INT32_MAX;
+    if (value < INT32_MIN) return INT32_MIN;
+    return (int32_t)value;
+}
+
+// Odd phase on a window of the last 2 * half_taps samples, oldest first.
+// The taps are symmetric around the middle of the window. Both samples of a
+// pair get their own 32x32 multiply-accumulate (SMLAL on the M33), adding
+// them first would need a 64-bit product.
+static inline int64_t odd_phase(const int32_t *c, uint32_t half_taps, const int32_t *w) {
+    int64_t acc = 0;
+    for (uint32_t k = 1; k <= half_taps; k++) {
+        acc += (int64_t)c[k - 1] * w[half_taps - k];
+        acc += (int64_t)c[k - 1] * w[half_taps - 1 + k];
+    }
+    return acc;
+}
+
+void halfband_reset(halfband_state_t *s) {
+    memset(s, 0, sizeof(*s));
+}
+
+// The kernels are inlined for each filter length, so the tap loops unroll
+static inline void upsample(const int32_t *c, const uint32_t m, halfband_state_t *s,
+                            const int32_t *input, uint32_t in_stride, int32_t *output, uint32_t frames) {
+    const uint32_t len = 2 * m;
+    uint32_t pos = s->pos;
+    for (uint32_t i = 0; i < frames; i++) {
+        pos = (pos + 1 == len) ? 0 : pos + 1;
+        s->history[pos] = s->history[pos + len] = input[i * in_stride];
+        const int32_t *w = &s->history[pos + 1];
+
+        // Zero stuffing halves the level, the taps are doubled to make up for it
+        int64_t acc = odd_phase(c, m, w);
+        output[2 * i] = w[m - 1];
+        output[2 * i + 1] = saturate_sample((acc + ((int64_t)1 << (HALFBAND_FRAC_BITS - 2))) >> (HALFBAND_FRAC_BITS - 1));
+    }
+    s->pos = (uint8_t)pos;
+}
+
+static inline void downsample(const int32_t *c, const uint32_t m, halfband_state_t *s,
+                              const int32_t *input, int32_t *output, uint32_t out_stride, uint32_t frames) {
+    const uint32_t len = 2 * m;
+    uint32_t pos = s->pos;
+    for (uint32_t i = 0; i < frames; i++) {
+        pos = (pos + 1 == len) ? 0 : pos + 1;
+        s->even[pos] = s->even[pos + len] = input[2 * i];
+        s->history[pos] = s->history[pos + len] = input[2 * i + 1];
+        const int32_t *w = &s->history[pos + 1];
+
+        int64_t acc = odd_phase(c, m, w);
+        acc += (int64_t)s->even[pos + 1 + m] << (HALFBAND_FRAC_BITS - 1);  // Centre tap, 0.5
+        output[i * out_stride] = saturate_sample((acc + ((int64_t)1 << (HALFBAND_FRAC_BITS - 1))) >> HALFBAND_FRAC_BITS);
+    }
+    s->pos = (uint8_t)pos;
+}
+
+void halfband_upsample(const halfband_t *hb, halfband_state_t *s,
+                       const int32_t *input, uint32_t in_stride, int32_t *output, uint32_t frames) {
+    if (hb == &halfband_stage1) {
+        upsample(stage1_coeffs, 12, s, input, in_stride, output, frames);
+    } else if (hb == &halfband_stage2) {
+        upsample(stage2_coeffs, 4, s, input, in_stride, output, frames);
+    } else {
+        upsample(hb->coeffs, hb->half_taps, s, input, in_stride, output, frames);
+    }
+}
+
+void halfband_downsample(const halfband_t *hb, halfband_state_t *s,
+                         const int32_t *input, int32_t *output, uint32_t out_stride, uint32_t frames) {
+    if (hb == &halfband_stage1) {
+        downsample(stage1_coeffs, 12, s, input, output, out_stride, frames);
+    } else if (hb == &halfband_stage2) {
+        downsample(stage2_coeffs, 4, s, input, output, out_stride, frames);
+    } else {
+        downsample(hb->coeffs, hb->half_taps, s, input, output, out_stride, frames);
+    }
+}
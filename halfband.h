@@ -0,0 +1,59 @@
+#ifndef HALFBAND_H_
+#define HALFBAND_H_
+
+/* Polyphase halfband filters, to run the global distortion at 2x or 4x the
+ * sample rate.
+ * A halfband lowpass has every other coefficient at zero, apart from the
+ * centre one (0.5), so each rate change only computes the odd phase: that is
+ * 2 * half_taps multiply-accumulates per output.
+ * Going up, the even outputs are the input delayed. Going down, the even
+ * inputs only go through the centre tap.
+ *
+ * Samples are 32-bit bus samples (see audio_bus.h), coefficients are Q30 and
+ * products accumulate on 64 bits. Stages are cascaded for 4x: stage1 between
+ * 1x and 2x, with a narrow transition band, then stage2 between 2x and 4x,
+ * where the audio band is a small part of the spectrum and a few taps suffice.
+ */
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define HALFBAND_FRAC_BITS      30
+#define HALFBAND_MAX_HALF_TAPS  12  // Non-zero coefficients on each side of the centre
+
+typedef struct halfband {
+    const int32_t *coeffs;  // Odd taps 1, 3, 5... from the centre out, Q30
+    uint8_t half_taps;
+} halfband_t;
+
+// Delay lines are stored twice in a row, so the last 2 * half_taps samples
+// can be read without wrapping.
+typedef struct halfband_state {
+    int32_t history[4 * HALFBAND_MAX_HALF_TAPS];
+    int32_t even[4 * HALFBAND_MAX_HALF_TAPS];   // Downsampling only
+    uint8_t pos;
+} halfband_state_t;
+
+// 47 taps, passband to 0.2 of the 2x rate (17.6 kHz at 44.1 kHz), 76 dB stopband
+extern const halfband_t halfband_stage1;
+// 15 taps, passband to 0.1 of the 4x rate (the same 17.6 kHz), 73 dB stopband
+extern const halfband_t halfband_stage2;
+
+void halfband_reset(halfband_state_t *s);
+
+// frames input samples, read with in_stride, to 2 * frames contiguous output samples
+void halfband_upsample(const halfband_t *hb, halfband_state_t *s,
+                       const int32_t *input, uint32_t in_stride, int32_t *output, uint32_t frames);
+
+// 2 * frames contiguous input samples to frames output samples, written with out_stride
+void halfband_downsample(const halfband_t *hb, halfband_state_t *s,
+                         const int32_t *input, int32_t *output, uint32_t out_stride, uint32_t frames);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* HALFBAND_H_ */
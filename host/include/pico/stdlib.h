@@ -0,0 +1,29 @@
+#ifndef HOST_PICO_STDLIB_H_
+#define HOST_PICO_STDLIB_H_
+
+/* Minimal stand-in for the Pico SDK's pico/stdlib.h, so that the parts of
+ * the firmware that only need its types and clock can build on a host.
+ */
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <time.h>
+
+#define PICO_ON_DEVICE 0
+
+typedef unsigned int uint;
+typedef int32_t alarm_id_t;
+
+static inline uint64_t time_us_64(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000u + (uint64_t)ts.tv_nsec / 1000u;
+}
+
+static inline uint32_t time_us_32(void) {
+    return (uint32_t)time_us_64();
+}
+
+#endif /* HOST_PICO_STDLIB_H_ */
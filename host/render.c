@@ -0,0 +1,838 @@
+/* Diapasonix host render harness
+ * Plays a scripted note sequence through AMY and the global effects,
+ * with the same note logic as the firmware, as fast as the host allows.
+ * Reports blocks per second and per-stage timings, and can write a WAV file.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <math.h>
+
+#include "pico/stdlib.h"
+
+#include "amy.h"
+
+#include "config.h"
+#include "state_data.h"
+#include "synth.h"
+#include "global_filter.h"
+#include "global_distortion.h"
+#include "string_inserts.h"
+#include "fx_chain.h"
+#include "audio_bus.h"
+#include "biquad_fixed.h"
+#include "cycle_counter.h"
+#include "profiler.h"
+#include "clock_config.h"
+
+#define MAX_SCRIPT_EVENTS   4096
+
+typedef struct script_event {
+    uint32_t time_ms;
+    bool on;
+    uint8_t string;
+    uint8_t note;
+} script_event_t;
+
+static script_event_t script[MAX_SCRIPT_EVENTS];
+static uint32_t script_length;
+
+/* Firmware hooks that have no meaning offline */
+
+void request_flash_write(void) {
+    (void)0; // No-op
+}
+
+void run_midi() {
+    (void)0; // No-op
+}
+
+void amy_send_midi_note_on(uint16_t osc) {
+    (void)osc; // No-op
+}
+
+void amy_send_midi_note_off(uint16_t osc) {
+    (void)osc; // No-op
+}
+
+/* Note script */
+
+static void script_add(uint32_t time_ms, bool on, uint8_t string, uint8_t note) {
+    if (script_length < MAX_SCRIPT_EVENTS) {
+        script[script_length++] = (script_event_t){time_ms, on, string, note};
+    }
+}
+
+// Strum the default open strings every 500ms, letting each chord ring for 400ms
+static void script_default(uint32_t duration_ms) {
+    const uint8_t pitches[NUM_STRINGS] = {
+        DEFAULT_STRING_PITCH_0, DEFAULT_STRING_PITCH_1, DEFAULT_STRING_PITCH_2, DEFAULT_STRING_PITCH_3
+    };
+    const uint8_t frets[] = {0, 2, 4, 5, 7, 5, 4, 2};
+    uint32_t step = 0;
+
+    for (uint32_t t = 0; t + 500 <= duration_ms; t += 500, step++) {
+        uint8_t fret = frets[step % sizeof(frets)];
+        for (uint8_t s = 0; s < NUM_STRINGS; s++) {
+            script_add(t + s * 15, true, s, pitches[s] + fret);
+            script_add(t + 400, false, s, pitches[s] + fret);
+        }
+    }
+}
+
+// One event per line: <time_ms> <on|off> <string> <note>. Lines starting with # are ignored.
+static bool script_load(const char *path) {
+    FILE *f = fopen(path, "r");
+    if (!f) {
+        perror(path);
+        return false;
+    }
+
+    char line[128];
+    uint32_t line_num = 0;
+    while (fgets(line, sizeof(line), f)) {
+        line_num++;
+        if (line[0] == '#' || line[0] == '\n') continue;
+
+        unsigned time_ms, string, note;
+        char kind[4];
+        if (sscanf(line, "%u %3s %u %u", &time_ms, kind, &string, &note) != 4 ||
+            string >= NUM_STRINGS || note > MIDI_NOTE_MAX) {
+            fprintf(stderr, "%s:%u: invalid event\n", path, line_num);
+            fclose(f);
+            return false;
+        }
+        script_add(time_ms, strcmp(kind, "on") == 0, (uint8_t)string, (uint8_t)note);
+    }
+    fclose(f);
+
+    // Events are fired in order, so the script must be sorted by time
+    for (uint32_t i = 1; i < script_length; i++) {
+        if (script[i].time_ms < script[i - 1].time_ms) {
+            fprintf(stderr, "%s: events must be sorted by time\n", path);
+            return false;
+        }
+    }
+    return true;
+}
+
+/* WAV output */
+
+static void put_u16(uint8_t *p, uint16_t v) { p[0] = v; p[1] = v >> 8; }
+static void put_u32(uint8_t *p, uint32_t v) { p[0] = v; p[1] = v >> 8; p[2] = v >> 16; p[3] = v >> 24; }
+
+static void wav_write_header(FILE *f, uint32_t data_bytes) {
+    uint8_t h[44];
+    memcpy(h, "RIFF", 4);
+    put_u32(h + 4, 36 + data_bytes);
+    memcpy(h + 8, "WAVEfmt ", 8);
+    put_u32(h + 16, 16);
+    put_u16(h + 20, 1);                                     // PCM
+    put_u16(h + 22, AMY_NCHANS);
+    put_u32(h + 24, AMY_SAMPLE_RATE);
+    put_u32(h + 28, AMY_SAMPLE_RATE * AMY_NCHANS * sizeof(int16_t));
+    put_u16(h + 32, AMY_NCHANS * sizeof(int16_t));
+    put_u16(h + 34, 16);
+    memcpy(h + 36, "data", 4);
+    put_u32(h + 40, data_bytes);
+    fseek(f, 0, SEEK_SET);
+    fwrite(h, 1, sizeof(h), f);
+}
+
+// Checks a reference file is in the format this build writes, and skips to its samples
+static bool wav_read_header(FILE *f, const char *path) {
+    uint8_t h[44];
+    if (fread(h, 1, sizeof(h), f) != sizeof(h) || memcmp(h, "RIFF", 4) != 0 || memcmp(h + 8, "WAVEfmt ", 8) != 0) {
+        fprintf(stderr, "%s: not a WAV file written by this tool\n", path);
+        return false;
+    }
+    uint16_t channels = h[22] | h[23] << 8;
+    uint32_t rate = h[24] | h[25] << 8 | h[26] << 16 | (uint32_t)h[27] << 24;
+    if (channels != AMY_NCHANS || rate != AMY_SAMPLE_RATE) {
+        fprintf(stderr, "%s: %u channels at %u Hz, expected %u at %u Hz\n",
+                path, channels, rate, AMY_NCHANS, AMY_SAMPLE_RATE);
+        return false;
+    }
+    return true;
+}
+
+/* Null test against a reference render */
+
+static int64_t null_peak;
+static double null_sum_sq;
+static uint64_t null_count;
+
+static void null_test_block(FILE *ref, const int16_t *samples) {
+    int16_t ref_samples[AMY_BLOCK_SIZE * AMY_NCHANS];
+    size_t n = fread(ref_samples, sizeof(int16_t), AMY_BLOCK_SIZE * AMY_NCHANS, ref);
+    for (size_t i = 0; i < n; i++) {
+        int64_t diff = (int64_t)samples[i] - ref_samples[i];
+        if (llabs(diff) > null_peak) null_peak = llabs(diff);
+        null_sum_sq += (double)(diff * diff);
+    }
+    null_count += n;
+}
+
+static double to_dbfs(double value) {
+    return value > 0 ? 20.0 * log10(value / 32768.0) : -INFINITY;
+}
+
+static void null_test_report(void) {
+    double rms = null_count ? sqrt(null_sum_sq / null_count) : 0;
+    printf("Null test over %llu samples: peak difference %lld (%.1f dBFS), RMS %.1f dBFS\n",
+           (unsigned long long)null_count, (long long)null_peak, to_dbfs((double)null_peak), to_dbfs(rms));
+}
+
+/* Effects */
+
+static const struct {
+    const char *name;
+    amy_fx_t fx;
+} fx_names[] = {
+    {"reverb", REVERB},
+    {"chorus", CHORUS},
+    {"echo", ECHO},
+    {"filter", FILTER},
+    {"distortion", DISTORTION},
+};
+
+#define NUM_FX (sizeof(fx_names) / sizeof(fx_names[0]))
+
+// Comma separated list of effects to enable, "all" or "none"
+static bool parse_fx(const char *list) {
+    for (uint i = 0; i < NUM_FX; i++) {
+        set_fx(fx_names[i].fx, strcmp(list, "all") == 0);
+    }
+    if (strcmp(list, "all") == 0 || strcmp(list, "none") == 0) {
+        return true;
+    }
+
+    char buf[128];
+    strncpy(buf, list, sizeof(buf) - 1);
+    buf[sizeof(buf) - 1] = '\0';
+    for (char *name = strtok(buf, ","); name; name = strtok(NULL, ",")) {
+        uint i;
+        for (i = 0; i < NUM_FX; i++) {
+            if (strcmp(name, fx_names[i].name) == 0) {
+                set_fx(fx_names[i].fx, true);
+                break;
+            }
+        }
+        if (i == NUM_FX) {
+            fprintf(stderr, "Unknown effect: %s\n", name);
+            return false;
+        }
+    }
+    return true;
+}
+
+// Effects to place per string instead of on the mix: filter, distortion or both
+static bool parse_placement(const char *list) {
+    char buf[64];
+    strncpy(buf, list, sizeof(buf) - 1);
+    buf[sizeof(buf) - 1] = '\0';
+    for (char *name = strtok(buf, ","); name; name = strtok(NULL, ",")) {
+        if (strcmp(name, "filter") == 0) {
+            set_filter_per_string(true);
+        } else if (strcmp(name, "distortion") == 0) {
+            set_distortion_per_string(true);
+        } else {
+            fprintf(stderr, "No per-string placement for: %s\n", name);
+            return false;
+        }
+    }
+    return true;
+}
+
+// Order of the effects after AMY, as the chain's node names, e.g. filter,distortion
+static bool parse_order(const char *list) {
+    for (uint8_t order = 0; order < FX_ORDER_COUNT; order++) {
+        fx_chain_set_order(order);
+        char names[64] = "";
+        const fx_node_t *node;
+        for (uint8_t n = 0; (node = fx_chain_node(n)) != NULL; n++) {
+            if (n > 0) strncat(names, ",", sizeof(names) - strlen(names) - 1);
+            strncat(names, node->name, sizeof(names) - strlen(names) - 1);
+        }
+        if (strcmp(list, names) == 0) {
+            set_fx_order(order);
+            return true;
+        }
+    }
+    fx_chain_set_order(get_fx_order());
+    fprintf(stderr, "Unknown effects order: %s\n", list);
+    return false;
+}
+
+static uint32_t silent_blocks;
+static bus_sample_t bus_block[AMY_BLOCK_SIZE * AMY_NCHANS];
+
+// Same block flow as rp2040_fill_audio_buffer() in multicore_audio.c,
+// with one core rendering all the oscillators (or all the strings)
+static void render_block(int16_t *samples) {
+    uint32_t t = profiler_start();
+    amy_execute_deltas();
+    profiler_stop(PROFILE_STAGE_DELTAS, t);
+
+    if (synth_is_silent()) {
+        amy_render(0, 0, 0);
+        amy_fill_buffer();
+        memset(samples, 0, AMY_BLOCK_SIZE * AMY_NCHANS * sizeof(int16_t));
+        silent_blocks++;
+        return;
+    }
+
+    t = profiler_start();
+    if (string_inserts_active() && string_inserts_prepare()) {
+        string_inserts_render(0, NUM_STRINGS, 0);
+    } else {
+        amy_render(0, AMY_OSCS, 0);
+    }
+    profiler_stop(PROFILE_STAGE_RENDER_CORE0, t);
+
+    t = profiler_start();
+    int16_t *block = amy_fill_buffer();
+    profiler_stop(PROFILE_STAGE_MIX, t);
+    synth_update_activity(block);
+
+    if (!fx_chain_mix_active()) {
+        memcpy(samples, block, AMY_BLOCK_SIZE * AMY_NCHANS * sizeof(int16_t));
+        return;
+    }
+
+    t = profiler_start();
+    audio_bus_from_int16_block(block, bus_block, AMY_BLOCK_SIZE * AMY_NCHANS);
+    uint32_t bus_time = cycle_counter_elapsed(t, profiler_start());
+
+    fx_chain_process_mix(bus_block, AMY_BLOCK_SIZE);
+
+    t = profiler_start();
+    audio_bus_to_int16_block(bus_block, samples, AMY_BLOCK_SIZE * AMY_NCHANS);
+    profiler_record(PROFILE_STAGE_BUS, bus_time + cycle_counter_elapsed(t, profiler_start()));
+}
+
+/* Global filter response */
+
+// Gain in dB of the global filter for a sine at freq_hz, once it has settled
+static double measure_filter_gain(uint8_t type, float cutoff_hz, float q, float freq_hz) {
+    static bus_sample_t buffer[AMY_BLOCK_SIZE * AMY_NCHANS];
+    const uint32_t blocks = AMY_SAMPLE_RATE / AMY_BLOCK_SIZE;  // About one second
+    double in_sq = 0, out_sq = 0;
+    uint32_t n = 0;
+
+    global_filter_set_enabled(false);  // Clears the state
+    config_global_filter(type, cutoff_hz, q);
+    global_filter_set_enabled(true);
+    for (uint32_t b = 0; b < blocks; b++) {
+        for (uint16_t i = 0; i < AMY_BLOCK_SIZE; i++) {
+            double phase = 2.0 * M_PI * freq_hz * (double)(b * AMY_BLOCK_SIZE + i) / AMY_SAMPLE_RATE;
+            bus_sample_t s = (bus_sample_t)(0.25 * AUDIO_BUS_ONE * sin(phase));
+            for (int c = 0; c < AMY_NCHANS; c++) {
+                buffer[AMY_NCHANS * i + c] = s;
+            }
+            if (b >= blocks / 2) in_sq += (double)s * s;
+        }
+        global_filter_process(buffer, buffer, AMY_BLOCK_SIZE);
+        if (b >= blocks / 2) {
+            for (uint16_t i = 0; i < AMY_BLOCK_SIZE; i++) {
+                out_sq += (double)buffer[AMY_NCHANS * i] * buffer[AMY_NCHANS * i];
+            }
+            n += AMY_BLOCK_SIZE;
+        }
+    }
+    global_filter_set_enabled(false);
+    return n && in_sq > 0 ? 10.0 * log10(out_sq / in_sq) : 0;
+}
+
+// One line per filter type: gain at a few frequencies around a 1 kHz cutoff
+static void print_filter_responses(void) {
+    static const char *names[FILTER_TYPE_COUNT] = {"LPF24", "LPF12", "HPF24", "HPF12", "BPF24", "BPF12", "NOTCH24", "NOTCH12"};
+    static const float freqs[] = {100, 250, 500, 1000, 2000, 4000, 10000};
+    const float cutoff = 1000.0f, q = 0.707f;
+    global_filter_init();
+    printf("Cutoff %.0f Hz, Q %.3f, gain in dB\n%-8s", cutoff, q, "Type");
+    for (size_t f = 0; f < sizeof(freqs) / sizeof(freqs[0]); f++) {
+        printf("%8.0f", freqs[f]);
+    }
+    printf("\n");
+    for (uint8_t type = 0; type < FILTER_TYPE_COUNT; type++) {
+        printf("%-8s", names[type]);
+        for (size_t f = 0; f < sizeof(freqs) / sizeof(freqs[0]); f++) {
+            printf("%8.1f", measure_filter_gain(type, cutoff, q, freqs[f]));
+        }
+        printf("\n");
+    }
+}
+
+/* Fixed-point biquad check */
+
+#define BIQUAD_CHECK_BLOCKS 200
+
+// Test signal on the bus: a sine plus noise, about -6 dBFS, different on each channel
+static void biquad_check_signal(int32_t *block, uint32_t b, uint32_t *seed) {
+    for (uint16_t i = 0; i < AMY_BLOCK_SIZE; i++) {
+        double t = (double)(b * AMY_BLOCK_SIZE + i) / AMY_SAMPLE_RATE;
+        for (int c = 0; c < 2; c++) {
+            *seed = *seed * 1664525u + 1013904223u;
+            double noise = ((int32_t)*seed >> 8) / (double)(1 << 23);
+            double v = 0.35 * sin(2.0 * M_PI * (220.0 + 110.0 * c) * t) + 0.15 * noise;
+            block[2 * i + c] = (int32_t)(v * AUDIO_BUS_ONE);
+        }
+    }
+}
+
+// Runs biquad_q_process_stereo() against biquad_q_process_ref() for every type over
+// a few cutoffs and Qs. Reports mismatching samples (must be 0), the error against a
+// double precision filter in int16 steps, and the time per stereo block of each.
+// Returns false on a mismatch.
+static bool check_fixed_biquad(void) {
+    static const float cutoffs[] = {40.0f, 1000.0f, 12000.0f};
+    static const float qs[] = {0.707f, 6.0f};
+    static int32_t input[AMY_BLOCK_SIZE * 2], ref[AMY_BLOCK_SIZE * 2], fast[AMY_BLOCK_SIZE * 2];
+    uint64_t mismatches = 0;
+    uint64_t ref_ns = 0, fast_ns = 0, blocks = 0;
+
+    printf("Type  Cutoff      Q  Mismatches  Max error (int16 steps)\n");
+    for (uint8_t type = 0; type < FILTER_TYPE_COUNT; type++) {
+        bool two_stages = (type & 1) == 0;
+        for (size_t f = 0; f < sizeof(cutoffs) / sizeof(cutoffs[0]); f++) {
+            for (size_t k = 0; k < sizeof(qs) / sizeof(qs[0]); k++) {
+                float coeffs[5];
+                global_filter_gen_coeffs(coeffs, type, cutoffs[f] / AMY_SAMPLE_RATE, qs[k]);
+                biquad_q_coeffs_t q[2];
+                biquad_q_coeffs_from_float(&q[0], coeffs);
+                q[1] = q[0];
+                biquad_q_state_t ref_state[2][2] = {0}, fast_state[2][2] = {0};
+                double dz[2][2][4] = {0};  // Double precision direct form I, same coefficients
+                uint64_t case_mismatches = 0;
+                double max_error = 0;
+                uint32_t seed = 1;
+
+                for (uint32_t b = 0; b < BIQUAD_CHECK_BLOCKS; b++) {
+                    biquad_check_signal(input, b, &seed);
+
+                    uint32_t t = cycle_counter_now();
+                    for (int c = 0; c < 2; c++) {
+                        biquad_q_process_ref(&q[c], &ref_state[c][0], input + c, ref + c, AMY_BLOCK_SIZE, 2);
+                        if (two_stages) {
+                            biquad_q_process_ref(&q[c], &ref_state[c][1], ref + c, ref + c, AMY_BLOCK_SIZE, 2);
+                        }
+                    }
+                    ref_ns += cycle_counter_elapsed(t, cycle_counter_now());
+
+                    int32_t input_or;
+                    t = cycle_counter_now();
+                    biquad_q_process_stereo(q, fast_state, input, fast, AMY_BLOCK_SIZE, two_stages, &input_or);
+                    fast_ns += cycle_counter_elapsed(t, cycle_counter_now());
+                    blocks++;
+
+                    for (uint32_t i = 0; i < AMY_BLOCK_SIZE * 2; i++) {
+                        if (ref[i] != fast[i]) case_mismatches++;
+                        int c = i & 1;
+                        double y = 0;
+                        for (int s = 0; s < (two_stages ? 2 : 1); s++) {
+                            double x = s == 0 ? (double)input[i] : y;
+                            double *z = dz[c][s];
+                            y = coeffs[0] * x + coeffs[1] * z[0] + coeffs[2] * z[1] - coeffs[3] * z[2] - coeffs[4] * z[3];
+                            z[1] = z[0]; z[0] = x; z[3] = z[2]; z[2] = y;
+                        }
+                        double error = fabs(fast[i] - y) / (1 << AUDIO_BUS_INT16_SHIFT);
+                        if (error > max_error) max_error = error;
+                    }
+                }
+                mismatches += case_mismatches;
+                printf("%-4u  %6.0f  %5.3f  %10llu  %.4f\n", type, cutoffs[f], qs[k],
+                       (unsigned long long)case_mismatches, max_error);
+            }
+        }
+    }
+    printf("Per stereo block: reference %.0f ns, kernel %.0f ns\n",
+           (double)ref_ns / blocks, (double)fast_ns / blocks);
+    printf("Global filter per block: float %u ns, fixed point %u ns\n",
+           global_filter_benchmark(false), global_filter_benchmark(true));
+    printf("%s\n", mismatches ? "FAIL: the kernel differs from the reference" : "OK: bit-exact");
+    return mismatches == 0;
+}
+
+// Table-driven distortion against the float implementation it replaces: every
+// int16 input, plus a ramp past full scale as a summed bus can carry, for each
+// model with a table (all but crush)
+static bool check_distortion_table(void) {
+    static const char *models[DISTORTION_MODEL_COUNT] = {"harsh", "soft", "tube", "fuzz", "crush"};
+    static const float levels[] = {0.1f, 0.5f, 1.0f};
+    static const float gains[] = {10.0f, 15.0f, 20.0f};
+    static int32_t input[AMY_BLOCK_SIZE * 2], ref[AMY_BLOCK_SIZE * 2], fast[AMY_BLOCK_SIZE * 2];
+    const uint32_t block_samples = AMY_BLOCK_SIZE * 2;
+    const int32_t over_range = 2 * AUDIO_BUS_ONE;
+    uint64_t ref_ns = 0, fast_ns = 0, blocks = 0;
+    double worst = 0;
+
+    global_distortion_init();
+    global_distortion_set_enabled(true);
+    printf("Model  Level  Gain  Max error (int16 steps)\n");
+    for (uint8_t model = 0; model < DISTORTION_MODEL_COUNT; model++) {
+        if (model == DISTORTION_MODEL_CRUSH) continue;
+        for (size_t l = 0; l < sizeof(levels) / sizeof(levels[0]); l++) {
+            for (size_t g = 0; g < sizeof(gains) / sizeof(gains[0]); g++) {
+                config_global_distortion(model, levels[l], gains[g]);
+                double max_error = 0;
+                int32_t next = INT16_MIN;
+                int32_t over = -over_range;
+                while (next <= INT16_MAX || over <= over_range) {
+                    for (uint32_t i = 0; i < block_samples; i++) {
+                        if (next <= INT16_MAX) {
+                            input[i] = next++ << AUDIO_BUS_INT16_SHIFT;
+                        } else {
+                            input[i] = over;
+                            over += over_range / 4096;
+                        }
+                    }
+
+                    uint32_t t = cycle_counter_now();
+                    global_distortion_process_reference(input, ref, AMY_BLOCK_SIZE);
+                    ref_ns += cycle_counter_elapsed(t, cycle_counter_now());
+                    t = cycle_counter_now();
+                    global_distortion_process(input, fast, AMY_BLOCK_SIZE);
+                    fast_ns += cycle_counter_elapsed(t, cycle_counter_now());
+                    blocks++;
+
+                    for (uint32_t i = 0; i < block_samples; i++) {
+                        double error = fabs((double)fast[i] - ref[i]) / (1 << AUDIO_BUS_INT16_SHIFT);
+                        if (error > max_error) max_error = error;
+                    }
+                }
+                if (max_error > worst) worst = max_error;
+                printf("%-5s  %5.2f  %4.0f  %.4f\n", models[model], levels[l], gains[g], max_error);
+            }
+        }
+    }
+    global_distortion_init();
+    printf("Per stereo block: float %.0f ns, table %.0f ns\n",
+           (double)ref_ns / blocks, (double)fast_ns / blocks);
+    bool ok = worst < 0.5;
+    printf("%s\n", ok ? "OK: within half an int16 step" : "FAIL: the table is off by half an int16 step or more");
+    return ok;
+}
+
+#define ALIAS_TEST_FRAMES   8192    // Analysis length, a power of two
+#define ALIAS_TEST_WARMUP   16      // Blocks run first, for the filters to settle
+
+// Power of the DFT bin of one channel of an interleaved stereo signal (Goertzel)
+static double dft_bin_power(const int32_t *signal, uint32_t frames, uint32_t bin) {
+    double w = 2.0 * M_PI * bin / frames;
+    double coeff = 2.0 * cos(w);
+    double s1 = 0, s2 = 0;
+    for (uint32_t i = 0; i < frames; i++) {
+        double s0 = signal[2 * i] + coeff * s1 - s2;
+        s2 = s1;
+        s1 = s0;
+    }
+    return s1 * s1 + s2 * s2 - coeff * s1 * s2;
+}
+
+// A sine sitting exactly on a DFT bin, through the distortion at full level
+// and gain. The output repeats every ALIAS_TEST_FRAMES frames, so all of its
+// power lands on bins: harmonics of the tone where they belong, aliases on
+// the others (an odd bin never folds onto one of its own harmonics).
+// Prints harmonics against everything else, for each oversampling factor.
+static void print_distortion_aliasing(void) {
+    static const uint32_t bins[] = {185, 557, 1117};   // ~1, 3 and 6 kHz at 44.1 kHz
+    static const char *names[DISTORTION_OVERSAMPLE_COUNT] = {"1x", "2x", "4x"};
+    static int32_t signal[ALIAS_TEST_FRAMES * 2];
+    const uint32_t blocks = ALIAS_TEST_FRAMES / AMY_BLOCK_SIZE;
+
+    printf("Tone (Hz)  Oversampling  Aliases (dB below harmonics)  Per stereo block\n");
+    for (size_t b = 0; b < sizeof(bins) / sizeof(bins[0]); b++) {
+        for (uint8_t factor = 0; factor < DISTORTION_OVERSAMPLE_COUNT; factor++) {
+            global_distortion_init();
+            global_distortion_set_enabled(true);
+            config_global_distortion(DISTORTION_MODEL_HARSH, 1.0f, 20.0f);
+            global_distortion_set_oversampling(factor);
+
+            uint64_t ns = 0;
+            for (uint32_t n = 0; n < ALIAS_TEST_WARMUP + blocks; n++) {
+                uint32_t block = n % blocks;
+                int32_t *frames = signal + block * AMY_BLOCK_SIZE * 2;
+                for (uint32_t i = 0; i < AMY_BLOCK_SIZE; i++) {
+                    uint32_t t = block * AMY_BLOCK_SIZE + i;
+                    double phase = 2.0 * M_PI * (double)((uint64_t)bins[b] * t % ALIAS_TEST_FRAMES) / ALIAS_TEST_FRAMES;
+                    frames[2 * i] = frames[2 * i + 1] = (int32_t)lrint(0.5 * sin(phase) * AUDIO_BUS_ONE);
+                }
+                uint32_t start = cycle_counter_now();
+                global_distortion_process(frames, frames, AMY_BLOCK_SIZE);
+                ns += cycle_counter_elapsed(start, cycle_counter_now());
+            }
+            // The first blocks were overwritten by later passes, the buffer
+            // now holds one full period of the settled output
+
+            double total = 0;
+            for (uint32_t i = 0; i < ALIAS_TEST_FRAMES; i++) {
+                total += (double)signal[2 * i] * signal[2 * i];
+            }
+            total *= ALIAS_TEST_FRAMES / 2.0;   // Parseval, one side of the spectrum
+            double dc = dft_bin_power(signal, ALIAS_TEST_FRAMES, 0) / 2.0;
+            double harmonics = 0;
+            for (uint32_t h = bins[b]; h < ALIAS_TEST_FRAMES / 2; h += bins[b]) {
+                harmonics += dft_bin_power(signal, ALIAS_TEST_FRAMES, h);
+            }
+            double aliases = total - dc - harmonics;
+            printf("%9.0f  %12s  %28.1f  %.0f ns\n",
+                   (double)bins[b] * AMY_SAMPLE_RATE / ALIAS_TEST_FRAMES, names[factor],
+                   10.0 * log10(harmonics / (aliases > 0 ? aliases : 1e-30)),
+                   (double)ns / (ALIAS_TEST_WARMUP + blocks));
+        }
+    }
+    global_distortion_init();
+}
+
+/* Per-string inserts */
+
+#define INSERT_TEST_BLOCKS  2000
+
+// Time per block of the inserts of one string, then of every string, each
+// fed its own open string tone, next to the cost model's estimate for the
+// device (share of a block on the busiest core)
+static void print_insert_costs(void) {
+    static const struct {
+        const char *name;
+        bool distortion;
+        uint8_t oversampling;
+        bool filter;
+        float wah_octaves;
+    } cases[] = {
+        {"Distortion 1x", true, DISTORTION_OVERSAMPLE_OFF, false, 0.0f},
+        {"Distortion 2x", true, DISTORTION_OVERSAMPLE_2X, false, 0.0f},
+        {"Distortion 4x", true, DISTORTION_OVERSAMPLE_4X, false, 0.0f},
+        {"Filter", false, 0, true, 0.0f},
+        {"Filter + wah", false, 0, true, 2.0f},
+        {"Distortion 2x + filter", true, DISTORTION_OVERSAMPLE_2X, true, 0.0f},
+    };
+    static const float tones_hz[NUM_STRINGS] = {82.41f, 110.0f, 146.83f, 196.0f};
+    static bus_sample_t blocks[NUM_STRINGS][AMY_BLOCK_SIZE * AMY_NCHANS];
+
+    printf("Inserts                 1 string  %u strings  Estimated load (budget %u%%)\n",
+           NUM_STRINGS, STRING_INSERTS_BUDGET_PERCENT);
+    for (size_t c = 0; c < sizeof(cases) / sizeof(cases[0]); c++) {
+        global_distortion_init();
+        global_filter_init();
+        global_distortion_set_enabled(cases[c].distortion);
+        config_global_distortion(DISTORTION_MODEL_HARSH, 1.0f, 15.0f);
+        global_distortion_set_oversampling(cases[c].oversampling);
+        global_distortion_set_per_string(true);
+        global_filter_set_enabled(cases[c].filter);
+        config_global_filter(FILTER_TYPE_LPF24, 1200.0f, 2.0f);
+        config_global_filter_envelope(cases[c].wah_octaves, 5.0f, 150.0f);
+        global_filter_set_per_string(true);
+
+        double ns_per_block[2];
+        for (uint8_t pass = 0; pass < 2; pass++) {
+            uint8_t strings = pass == 0 ? 1 : NUM_STRINGS;
+            uint64_t ns = 0;
+            for (uint32_t b = 0; b < INSERT_TEST_BLOCKS; b++) {
+                for (uint8_t s = 0; s < strings; s++) {
+                    for (uint32_t i = 0; i < AMY_BLOCK_SIZE; i++) {
+                        double t = (double)(b * AMY_BLOCK_SIZE + i) / AMY_SAMPLE_RATE;
+                        int32_t v = (int32_t)lrint(0.25 * sin(2.0 * M_PI * tones_hz[s] * t) * AUDIO_BUS_ONE);
+                        blocks[s][AMY_NCHANS * i] = blocks[s][AMY_NCHANS * i + 1] = v;
+                    }
+                }
+                uint32_t start = cycle_counter_now();
+                for (uint8_t s = 0; s < strings; s++) {
+                    fx_chain_process_string(s, 0, blocks[s], AMY_BLOCK_SIZE);
+                }
+                ns += cycle_counter_elapsed(start, cycle_counter_now());
+            }
+            ns_per_block[pass] = (double)ns / INSERT_TEST_BLOCKS;
+        }
+        printf("%-22s  %5.0f ns  %7.0f ns  %u%%%s\n", cases[c].name, ns_per_block[0], ns_per_block[1],
+               string_inserts_load_percent(), string_inserts_over_budget() ? " (over budget)" : "");
+    }
+    global_distortion_init();
+    global_filter_init();
+}
+
+/* Clock profiles */
+
+#define CLOCK_CHECK_MAX_PPM 10      // The table is within 2 ppm, a new entry must stay close
+
+// The firmware's clock table: system clock, I2S divider and the rate it really plays at.
+// Fails if a rate is off by more than CLOCK_CHECK_MAX_PPM, or if its divider
+// doesn't fit the PIO's 16.8 one (integer part 1 to 65535).
+static bool print_clock_profiles(void) {
+    uint8_t failed = 0;
+    printf("  Rate    System clock  PIO divider     Actual rate  Error\n");
+    for (uint8_t i = 0; i < clock_profile_count(); i++) {
+        const clock_profile_t *profile = clock_profile_get(i);
+        uint32_t sys_hz = clock_profile_sys_hz(profile);
+        uint32_t divider = clock_i2s_divider(sys_hz, profile->sample_rate);
+        uint64_t actual_mhz = clock_i2s_actual_rate_mhz(sys_hz, divider);
+        double error_ppm = ((double)actual_mhz / 1000.0 - profile->sample_rate) / profile->sample_rate * 1e6;
+        printf("%c %-6u  %6.2f MHz    %4u + %3u/256  %9.3f Hz  %+.2f ppm\n",
+               profile->sample_rate == AMY_SAMPLE_RATE ? '*' : ' ',
+               profile->sample_rate, sys_hz / 1e6, divider >> 8, divider & 0xFF,
+               actual_mhz / 1000.0, error_ppm);
+        if (divider < 0x100 || divider > 0xFFFFFF) {
+            printf("  FAIL: the divider is out of the PIO's range\n");
+            failed++;
+        } else if (fabs(error_ppm) > CLOCK_CHECK_MAX_PPM) {
+            printf("  FAIL: more than %d ppm off\n", CLOCK_CHECK_MAX_PPM);
+            failed++;
+        }
+    }
+    printf("%s\n", failed ? "FAIL" : "OK: every rate within range");
+    return failed == 0;
+}
+
+static void usage(const char *prog) {
+    fprintf(stderr,
+            "Usage: %s [options]\n"
+            "  -p PATCH   AMY patch number (default %d)\n"
+            "  -x LIST    effects to enable: comma separated list of\n"
+            "             reverb,chorus,echo,filter,distortion, or all, or none (default none)\n"
+            "  -m LIST    effects to place per string instead of on the mix:\n"
+            "             comma separated list of filter,distortion\n"
+            "  -g LIST    order of the effects after AMY: distortion,filter (default)\n"
+            "             or filter,distortion\n"
+            "  -s SEC     seconds of audio to render (default 10)\n"
+            "  -i FILE    note script, one '<time_ms> <on|off> <string> <note>' per line\n"
+            "             (default: strummed chords every 500ms, see host/scripts for more)\n"
+            "  -o FILE    write the rendered audio to a WAV file\n"
+            "  -r FILE    null test: compare the render with a WAV file written by -o,\n"
+            "             with the same options, and print the difference\n"
+            "  -c         print the clock profiles (* = the one built in), check their\n"
+            "             error and divider range and exit\n"
+            "  -f         print the measured response of each global filter type and exit\n"
+            "  -q         check the fixed-point biquad kernel against its reference and exit\n"
+            "  -d         check the table-driven distortion against the float one and exit\n"
+            "  -a         print the aliasing and time per block of each distortion oversampling factor and exit\n"
+            "  -n         print the time per block of the per-string inserts, for one string and\n"
+            "             for all of them, with the estimated load on the device, and exit\n",
+            prog, DEFAULT_PATCH);
+}
+
+int main(int argc, char **argv) {
+    initialize_default_settings();
+
+    const char *script_path = NULL;
+    const char *wav_path = NULL;
+    const char *ref_path = NULL;
+    uint32_t duration_ms = 10000;
+    int opt;
+
+    while ((opt = getopt(argc, argv, "p:x:m:g:s:i:o:r:cfqdanh")) != -1) {
+        switch (opt) {
+            case 'p': set_patch((uint16_t)atoi(optarg)); break;
+            case 'x': if (!parse_fx(optarg)) return 1; break;
+            case 'm': if (!parse_placement(optarg)) return 1; break;
+            case 'g': if (!parse_order(optarg)) return 1; break;
+            case 's': duration_ms = (uint32_t)(atof(optarg) * 1000.0); break;
+            case 'i': script_path = optarg; break;
+            case 'o': wav_path = optarg; break;
+            case 'r': ref_path = optarg; break;
+            case 'c': return print_clock_profiles() ? 0 : 1;
+            case 'f': print_filter_responses(); return 0;
+            case 'q': return check_fixed_biquad() ? 0 : 1;
+            case 'd': return check_distortion_table() ? 0 : 1;
+            case 'a': print_distortion_aliasing(); return 0;
+            case 'n': print_insert_costs(); return 0;
+            default: usage(argv[0]); return opt == 'h' ? 0 : 1;
+        }
+    }
+
+    if (script_path) {
+        if (!script_load(script_path)) return 1;
+    } else {
+        script_default(duration_ms);
+    }
+
+    FILE *wav = NULL;
+    if (wav_path) {
+        wav = fopen(wav_path, "wb");
+        if (!wav) {
+            perror(wav_path);
+            return 1;
+        }
+        wav_write_header(wav, 0);
+    }
+
+    FILE *ref = NULL;
+    if (ref_path) {
+        ref = fopen(ref_path, "rb");
+        if (!ref) {
+            perror(ref_path);
+            return 1;
+        }
+        if (!wav_read_header(ref, ref_path)) return 1;
+    }
+
+    // Same engine setup as the firmware
+    amy_config_t amy_config = amy_default_config();
+    amy_config.audio = AMY_AUDIO_IS_NONE;
+    amy_config.features.default_synths = 0;
+    amy_config.features.echo = 1;
+    amy_start(amy_config);
+    global_filter_init();
+    global_distortion_init();
+    amy_global.running = 1;
+
+    update_patch();
+    for (uint i = 0; i < NUM_FX; i++) {
+        update_fx(fx_names[i].fx);
+    }
+    update_volume();
+
+    static int16_t samples[AMY_BLOCK_SIZE * AMY_NCHANS];
+    uint32_t total_blocks = (uint32_t)((uint64_t)duration_ms * AMY_SAMPLE_RATE / 1000 / AMY_BLOCK_SIZE);
+    uint32_t next_event = 0;
+    uint64_t render_us = 0;
+
+    for (uint32_t b = 0; b < total_blocks; b++) {
+        // Fire the events that are due at the start of this block
+        uint32_t now_ms = (uint32_t)((uint64_t)b * AMY_BLOCK_SIZE * 1000 / AMY_SAMPLE_RATE);
+        while (next_event < script_length && script[next_event].time_ms <= now_ms) {
+            script_event_t *ev = &script[next_event++];
+            if (ev->on) {
+                note_on(ev->string, ev->note);
+            } else {
+                note_off(ev->string, ev->note);
+            }
+        }
+
+        // Only the render itself is timed, not the WAV output
+        uint64_t start = time_us_64();
+        uint32_t block_start = profiler_start();
+        render_block(samples);
+        profiler_stop(PROFILE_STAGE_BLOCK, block_start);
+        render_us += time_us_64() - start;
+
+        if (wav) {
+            fwrite(samples, sizeof(int16_t), AMY_BLOCK_SIZE * AMY_NCHANS, wav);
+        }
+        if (ref) {
+            null_test_block(ref, samples);
+        }
+    }
+
+    if (wav) {
+        wav_write_header(wav, total_blocks * AMY_BLOCK_SIZE * AMY_NCHANS * sizeof(int16_t));
+        fclose(wav);
+    }
+
+    double seconds = render_us / 1e6;
+    double audio_seconds = (double)total_blocks * AMY_BLOCK_SIZE / AMY_SAMPLE_RATE;
+    printf("Patch %u, %u blocks (%.1fs of audio) in %.3fs\n", get_patch(), total_blocks, audio_seconds, seconds);
+    if (seconds > 0) {
+        printf("%.0f blocks/s, %.1fx realtime\n", total_blocks / seconds, audio_seconds / seconds);
+    }
+    printf("%u silent blocks skipped\n", silent_blocks);
+    profiler_report();
+
+    if (ref) {
+        null_test_report();
+        fclose(ref);
+    }
+
+    return 0;
+}
@@ -0,0 +1,211 @@
+/* Diapasonix render channel stress test
+ * A producer and a consumer thread hand jobs over through the render channel
+ * (render_channel.h), as Core0 and Core1 do on the device. Exits nonzero if
+ * a job is lost, seen twice or read inconsistently, or if a job cancelled by
+ * the producer is also claimed by the consumer.
+ *
+ *   ./build-host/render_channel_stress [jobs]
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <pthread.h>
+#include <sched.h>
+#include "render_channel.h"
+
+#define DEFAULT_JOBS        2000000
+
+static render_channel_t channel;
+static uint32_t job_count = DEFAULT_JOBS;
+static uint32_t start_seq;              // Sequence numbers continue from here
+static _Atomic uint32_t failures;
+
+// Sequence numbers skip 0, which means "nothing posted yet"
+static uint32_t seq_for_block(uint32_t block) {
+    uint64_t seq = (uint64_t)start_seq + 1 + block;
+    if (seq > UINT32_MAX) seq++;
+    return (uint32_t)seq;
+}
+
+// Every field of a job is derived from its block, so a torn copy shows up
+static uint32_t post_block(uint32_t block) {
+    return render_channel_post(&channel, block, (uint16_t)block, (uint16_t)~block);
+}
+
+static bool job_consistent(const render_job_t *job) {
+    return job->seq == seq_for_block(job->block) &&
+           job->osc_start == (uint16_t)job->block &&
+           job->osc_end == (uint16_t)~job->block;
+}
+
+static void fail(const char *what, uint32_t block) {
+    if (atomic_fetch_add(&failures, 1) < 10) {
+        fprintf(stderr, "FAIL: %s (block %u)\n", what, block);
+    }
+}
+
+// Start from a given sequence number, as if that many jobs had gone through
+static void channel_reset(uint32_t seq) {
+    render_channel_init(&channel);
+    atomic_store(&channel.posted_seq, seq);
+    atomic_store(&channel.claimed_seq, seq);
+    atomic_store(&channel.done_seq, seq);
+    start_seq = seq;
+}
+
+/* Handoff: every job is claimed and completed by the consumer */
+
+static void *handoff_consumer(void *arg) {
+    (void)arg;
+    uint32_t last_seq = start_seq;
+    uint32_t expected = 0;
+    render_job_t job;
+    for (uint32_t n = 0; n < job_count; n++) {
+        render_channel_wait(&channel, &last_seq, &job);
+        if (!job_consistent(&job)) {
+            fail("torn job", job.block);
+        } else if (job.block != expected) {
+            fail(job.block < expected ? "job seen twice" : "job lost", expected);
+        }
+        expected = job.block + 1;
+        if (!render_channel_claim(&channel, job.seq)) {
+            fail("claim failed, nothing was cancelled", job.block);
+            continue;
+        }
+        render_channel_complete(&channel, job.seq, job.block);
+    }
+    return NULL;
+}
+
+static void run_handoff(uint32_t first_seq) {
+    channel_reset(first_seq);
+    pthread_t consumer;
+    pthread_create(&consumer, NULL, handoff_consumer, NULL);
+    for (uint32_t block = 0; block < job_count; block++) {
+        uint32_t seq = post_block(block);
+        if (seq != seq_for_block(block)) {
+            fail("unexpected sequence number", block);
+        }
+        while (!render_channel_is_done(&channel, seq)) {
+            render_channel_doorbell_wait();
+        }
+        if (render_channel_job_cycles(&channel) != block) {
+            fail("completion of another job", block);
+        }
+    }
+    pthread_join(consumer, NULL);
+    printf("Handoff from %u: %u jobs\n", first_seq, job_count);
+}
+
+/* Cancel: the producer takes jobs back at random delays, as Core0 does when
+ * Core1 is late. Exactly one side must own each job. */
+
+static _Atomic uint8_t *owners;         // Per block: times it was claimed or cancelled
+static _Atomic bool producer_done;
+
+static uint32_t xorshift(uint32_t *state) {
+    uint32_t x = *state;
+    x ^= x << 13;
+    x ^= x >> 17;
+    x ^= x << 5;
+    return *state = x;
+}
+
+// A short spin, or a yield, which is what lets the other thread in when
+// both share one CPU
+static void random_delay(uint32_t *random) {
+    uint32_t r = xorshift(random);
+    if (r & 1) {
+        sched_yield();
+    } else {
+        for (volatile uint32_t spin = (r >> 1) % 256; spin > 0; spin--) {
+        }
+    }
+}
+
+static void *cancel_consumer(void *arg) {
+    (void)arg;
+    uint32_t last_seq = start_seq;
+    uint32_t random = 0x9E3779B9;
+    render_job_t job;
+    while (true) {
+        if (!render_channel_poll(&channel, &last_seq, &job)) {
+            if (atomic_load(&producer_done) &&
+                atomic_load(&channel.posted_seq) == last_seq) {
+                break;
+            }
+            render_channel_doorbell_wait();
+            continue;
+        }
+        // Late sometimes, for the producer to cancel
+        random_delay(&random);
+        if (!render_channel_claim(&channel, job.seq)) {
+            continue;   // Cancelled, the producer renders it
+        }
+        if (!job_consistent(&job)) {
+            fail("claimed a torn job", job.block);
+            continue;
+        }
+        atomic_fetch_add(&owners[job.block], 1);
+        render_channel_complete(&channel, job.seq, job.block);
+    }
+    return NULL;
+}
+
+static void run_cancel(uint32_t first_seq) {
+    channel_reset(first_seq);
+    atomic_store(&producer_done, false);
+    for (uint32_t block = 0; block < job_count; block++) {
+        atomic_store(&owners[block], 0);
+    }
+    pthread_t consumer;
+    pthread_create(&consumer, NULL, cancel_consumer, NULL);
+
+    uint32_t random = 0x2545F491;
+    uint32_t cancelled = 0;
+    for (uint32_t block = 0; block < job_count; block++) {
+        uint32_t seq = post_block(block);
+        random_delay(&random);
+        // Same as render_wait_for_core1() once the claim timeout is over
+        if (!render_channel_is_claimed(&channel, seq) && render_channel_cancel(&channel, seq)) {
+            atomic_fetch_add(&owners[block], 1);
+            cancelled++;
+            continue;
+        }
+        while (!render_channel_is_done(&channel, seq)) {
+            render_channel_doorbell_wait();
+        }
+    }
+    atomic_store(&producer_done, true);
+    pthread_join(consumer, NULL);
+
+    for (uint32_t block = 0; block < job_count; block++) {
+        uint8_t count = atomic_load(&owners[block]);
+        if (count != 1) {
+            fail(count ? "job owned by both sides" : "job owned by neither side", block);
+        }
+    }
+    printf("Cancel from %u: %u jobs, %u cancelled\n", first_seq, job_count, cancelled);
+}
+
+int main(int argc, char **argv) {
+    if (argc > 1) {
+        job_count = (uint32_t)strtoul(argv[1], NULL, 0);
+    }
+
+    run_handoff(0);
+    run_handoff(UINT32_MAX - job_count / 2);    // Wraps around halfway
+
+    owners = calloc(job_count, sizeof(*owners));
+    if (!owners) {
+        perror("calloc");
+        return 1;
+    }
+    run_cancel(0);
+    run_cancel(UINT32_MAX - job_count / 2);
+    free((void *)owners);
+
+    uint32_t failed = atomic_load(&failures);
+    printf("%s\n", failed ? "FAIL" : "OK");
+    return failed ? 1 : 0;
+}
@@ -23,12 +23,16 @@
 
 #include "global_filter.h"
 #include "global_distortion.h"
+#include "synth.h"
 #include "state_data.h"
 #include "touch.h"
 #include "flash.h"
 #include "fretboard.h"
 #include "display/display.h"
 #include "directional_switch.h"
+#include "scheduler.h"
+#include "clock_config.h"
+#include "cycle_counter.h"
 
 #if defined (USE_MIDI)
 #include "bsp/board_api.h"  // For TinyUSB Midi
@@ -44,30 +48,6 @@ struct audio_buffer_pool *ap;
 
 ssd1306_t display;
 
-amy_event e[NUM_STRINGS];
-
-#if defined (USE_MIDI)
-/* MIDI helper function */
-static inline uint32_t tud_midi_write24 (uint8_t jack_id, uint8_t b1, uint8_t b2, uint8_t b3) {
-    // Use static array to avoid stack corruption when called from multiple contexts
-    // But ensure thread-safety by copying values immediately
-    uint8_t msg[3];
-    msg[0] = b1;
-    msg[1] = b2;
-    msg[2] = b3;
-    
-    // Validate MIDI note range before sending
-    if(b1 == MIDI_NOTE_ON || b1 == MIDI_NOTE_OFF) {  // Note on or note off
-        if(b2 > MIDI_NOTE_MAX) {
-            // Invalid note - don't send
-            return 0;
-        }
-    }
-    
-    return tud_midi_stream_write(jack_id, msg, 3);
-}
-#endif
-
 /* Note and audio */
 
 int64_t power_on_complete() {
@@ -75,56 +55,6 @@ int64_t power_on_complete() {
     return 0;
 }
 
-void note_on(uint8_t string, uint8_t note) {
-    // Validate string is within bounds
-    if(string >= NUM_STRINGS) {
-        return;  // Invalid string index
-    }
-    
-    // Validate note is within MIDI range
-    if(note > MIDI_NOTE_MAX) {
-        return;  // Invalid note
-    }
-    
-    float velocity = 0.5;
-    e[string] = amy_default_event();
-    e[string].time = 0;
-    e[string].synth = string;  // Each string is its own instrument
-    e[string].midi_note = note;
-    e[string].velocity = velocity;
-    amy_add_event(&e[string]);
-    
-#if defined (USE_MIDI)
-    // Send MIDI note on message (MIDI_NOTE_ON = note on, channel 0)
-    // Double-check note value before sending to MIDI
-    uint8_t midi_note = note;
-    if(midi_note > MIDI_NOTE_MAX) {
-        midi_note = MIDI_NOTE_MAX;  // Clamp to valid range
-    }
-    
-    uint8_t midi_velocity = (uint8_t)(velocity * MIDI_NOTE_MAX);
-    tud_midi_write24(0, MIDI_NOTE_ON, midi_note, midi_velocity);
-#endif
-}
-
-void note_off(uint8_t string, uint8_t note) {
-    if(string >= NUM_STRINGS) {
-        return;
-    }
-    
-    e[string] = amy_default_event();
-    e[string].time = 0;
-    e[string].synth = string;
-    e[string].midi_note = note;
-    e[string].velocity = 0;  // velocity = 0 means note off
-    amy_add_event(&e[string]);
-    
-#if defined (USE_MIDI)
-    // Send MIDI note off message (MIDI_NOTE_OFF = note off, channel 0)
-    tud_midi_write24(0, MIDI_NOTE_OFF, note, 0);
-#endif
-}
-
 void power_on_led() {
     gpio_init(PICO_DEFAULT_LED_PIN);
     gpio_set_dir(PICO_DEFAULT_LED_PIN, GPIO_OUT);
@@ -149,133 +79,10 @@ void update_display() {
     set_draw_pending(true);
 }
 
-void update_patch() {
-    uint16_t patch_num = get_patch();
-    
-    // Set up each string as its own instrument
-    for(uint8_t i = 0; i < NUM_STRINGS; i++) {
-        // Create an event to load the patch for this string/instrument
-        e[i] = amy_default_event();
-        e[i].time = 0;
-        e[i].synth = i;                 // Each string is instrument 0, 1, 2, 3
-        e[i].patch_number = patch_num;  // Load the selected patch
-        e[i].num_voices = 1;            // Just one voice per string
-        amy_add_event(&e[i]);
-    }
-}
-
 void update_tuning() {
     set_draw_pending(true);
 }
 
-void update_volume() {
-    // Convert UI volume (0-8) to AMY volume (0-11.0 float)
-    uint8_t ui_volume = get_volume();
-    float amy_volume;
-    
-    if (ui_volume == 0) {
-        amy_volume = 0.0f;
-    } else {
-        amy_volume = ((float)ui_volume / 8.0f) * 11.0f;
-    }
-        
-    // Set AMY global volume directly
-    amy_global.volume = amy_volume;
-}
-
-void update_fx(amy_fx_t fx) {
-    switch(fx){
-        case REVERB:
-            config_reverb((float)get_fx(REVERB)*2.0f, get_reverb_liveness(), get_reverb_damping(), get_reverb_xover_hz());
-        break;
-        case CHORUS:
-            config_chorus((float)get_fx(CHORUS)*2.0f, get_chorus_max_delay(), get_chorus_lfo_freq(), get_chorus_depth());
-        break;
-        case ECHO:
-        {
-            // Ensure AMY is running and echo feature is enabled before configuring echo
-            if (!amy_global.running || !AMY_HAS_ECHO) {
-                break;
-            }
-            
-            float level = (float)get_fx(ECHO)*2.0f;
-            
-            config_echo(level, get_echo_delay_ms(), DIAPASONIX_ECHO_DEFAULT_MAX_DELAY_MS, get_echo_feedback(), get_echo_filter_coef());
-        }
-        break;
-        case FILTER:
-        {
-            bool enabled = get_fx(FILTER);
-            global_filter_set_enabled(enabled);
-            if (enabled) {
-                config_global_filter(get_filter_freq_hz(), get_filter_resonance());
-            }
-        }
-        break;
-        case DISTORTION:
-        {
-            bool enabled = get_fx(DISTORTION);
-            global_distortion_set_enabled(enabled);
-            if (enabled) {
-                config_global_distortion(get_distortion_level(), get_distortion_gain());
-            }
-        }
-        break;
-    }
-}
-
-void initialize_default_settings() {
-    // Settings not loaded, initialize state_data with default values
-    set_patch(DEFAULT_PATCH);
-
-    set_fx(REVERB, false);
-    set_fx(FILTER, false);
-    set_fx(CHORUS, false);
-    set_fx(ECHO, false);
-    set_fx(DISTORTION, false);
-    
-    // Initialize effect parameters with defaults
-    set_reverb_liveness(DIAPASONIX_REVERB_DEFAULT_LIVENESS);
-    set_reverb_damping(DIAPASONIX_REVERB_DEFAULT_DAMPING);
-    set_reverb_xover_hz(DIAPASONIX_REVERB_DEFAULT_XOVER_HZ);
-    
-    set_chorus_max_delay(DIAPASONIX_CHORUS_DEFAULT_MAX_DELAY);
-    set_chorus_lfo_freq(DIAPASONIX_CHORUS_DEFAULT_LFO_FREQ);
-    set_chorus_depth(DIAPASONIX_CHORUS_DEFAULT_MOD_DEPTH);
-    
-    set_echo_delay_ms(DIAPASONIX_ECHO_DEFAULT_DELAY_MS);
-    set_echo_feedback((float)DIAPASONIX_ECHO_DEFAULT_FEEDBACK);
-    set_echo_filter_coef((float)DIAPASONIX_ECHO_DEFAULT_FILTER_COEF);
-    
-    // TODO: Add filter type. The only available filter is LPF24,
-    // but AMY also supports HPF, BPF, and LPF.
-    set_filter_freq_hz(DIAPASONIX_FILTER_DEFAULT_FREQ_HZ);
-    set_filter_resonance(DIAPASONIX_FILTER_DEFAULT_RESONANCE);
-    
-    set_distortion_level(DIAPASONIX_DISTORTION_DEFAULT_LEVEL);
-    set_distortion_gain(DIAPASONIX_DISTORTION_DEFAULT_GAIN);
-    
-    set_volume(DEFAULT_VOLUME); // 0-8 range, gets converted to AMY's 0-11.0 range
-    set_contrast(CONTRAST_AUTO); // Automatic dimming of display brightness
-
-    set_string_pitch(0, DEFAULT_STRING_PITCH_0); // G3
-    set_string_pitch(1, DEFAULT_STRING_PITCH_1); // D3
-    set_string_pitch(2, DEFAULT_STRING_PITCH_2); // A2
-    set_string_pitch(3, DEFAULT_STRING_PITCH_3); // E2
-
-    set_playing_mode(false); // Start in tapping mode
-    set_lefthanded(false);
-    
-    set_preset_selected(-1); // No preset selected initially
-    
-    // Initialize advanced timing parameters with defaults
-    set_state_snapshot_window_ms(STATE_SNAPSHOT_WINDOW_MS);
-    set_fret_stale_timeout_ms(FRET_STALE_TIMEOUT_MS);
-    set_fret_very_recent_threshold_ms(FRET_VERY_RECENT_THRESHOLD_MS);
-    set_fret_post_strum_threshold_ms(FRET_POST_STRUM_THRESHOLD_MS);
-    set_fret_release_delay_ms(FRET_RELEASE_DELAY_MS);
-}
-
 /* Low battery */
 void battery_low_detected() {
     set_low_batt(true);
@@ -321,9 +128,97 @@ void amy_send_midi_note_off(uint16_t osc) {
     (void)osc; // No-op
 }
 
+/* Main loop tasks */
+
+static void display_refresh(void) {
+#if defined (DISPLAY_STRESS_TEST)
+    set_draw_pending(true); // Full redraw every time, as the worst case for audio
+#endif
+    display_task(&display); // Display I2C can be such a block, its rate is capped
+}
+
+#if defined (USE_MIDI)
+static void usb_poll(void) {
+    tud_task(); // TinyUSB device task
+}
+#endif
+
+#if !AUDIO_CORE1_ENGINE
+static scheduler_task_t audio_task = {
+    .name = "audio",
+    .run = rp2040_fill_audio_buffer,
+    .ready = audio_block_due,
+    .deadline_us = AMY_BLOCK_SIZE * 1000000 / AMY_SAMPLE_RATE, // One block
+};
+#endif
+
+#if defined (USE_MIDI)
+static scheduler_task_t usb_task = {
+    .name = "usb",
+    .run = usb_poll,
+    .period_us = TASK_USB_PERIOD_US,
+    .deadline_us = TASK_USB_PERIOD_US,
+};
+#endif
+
+static scheduler_task_t touch_task = {
+    .name = "touch",
+    .run = mpr121_task,
+    .period_us = TASK_TOUCH_PERIOD_US,
+    .deadline_us = TASK_TOUCH_PERIOD_US,
+};
+
+static scheduler_task_t buttons_task = {
+    .name = "buttons",
+    .run = directional_switch_task,
+    .period_us = TASK_BUTTONS_PERIOD_US,
+    .deadline_us = TASK_BUTTONS_PERIOD_US,
+};
+
+static scheduler_task_t display_refresh_task = {
+    .name = "display",
+    .run = display_refresh,
+    .period_us = TASK_DISPLAY_PERIOD_US,
+    .deadline_us = TASK_DISPLAY_PERIOD_US,
+};
+
+static scheduler_task_t flash_task = {
+    .name = "flash",
+    .run = flash_write_task,
+    .period_us = TASK_FLASH_PERIOD_US,
+};
+
+#if defined (SCHEDULER_STATS_PRINT_MS)
+static void print_scheduler_stats(void) {
+    scheduler_report();
+    scheduler_reset_stats();
+#if AUDIO_CORE1_ENGINE
+    // Touch to sound: the touch task period, plus the command latency, plus
+    // the blocks queued ahead of the new one in the I2S buffers
+    synth_cmd_stats_t cmds;
+    synth_get_cmd_stats(&cmds, true);
+    printf("Engine commands %lu, dropped %lu, max latency %lu us (+%lu us output queue)\n",
+           cmds.processed, cmds.dropped, cmds.max_latency_us, audio_latency_us(get_latency_profile()));
+#endif
+    audio_i2s_xrun_stats_t xruns;
+    audio_i2s_get_xrun_stats(&xruns);
+    printf("I2S underruns %lu, longest gap %lu us\n", xruns.underruns, xruns.longest_gap_us);
+}
+
+static scheduler_task_t stats_task = {
+    .name = "stats",
+    .run = print_scheduler_stats,
+    .period_us = SCHEDULER_STATS_PRINT_MS * 1000,
+};
+#endif
+
 int main() {
-    // Overclock to 226MHz
-    set_sys_clock_pll(VCO_FREQ, PLL_PD1, PLL_PD2); 
+    // Overclock to a system clock the sample rate divides evenly into
+    const clock_profile_t *clock_profile = clock_profile_for_rate(AMY_SAMPLE_RATE);
+    if (!clock_profile) {
+        panic("No clock profile for %d Hz\n", AMY_SAMPLE_RATE);
+    }
+    set_sys_clock_pll(clock_profile->vco_freq, clock_profile->post_div1, clock_profile->post_div2);
 
     stdio_init_all();
 
@@ -333,6 +228,7 @@ int main() {
     printf("%s\n", USB_STR_PRODUCT);
     printf("\n");
     printf("Clock is set to %d\n", clock_get_hz(clk_sys));
+    printf("Sample rate is %d Hz\n", AMY_SAMPLE_RATE);
 
     gpio_init(SDA_PIN);
     gpio_init(SCL_PIN);
@@ -378,6 +274,11 @@ int main() {
     // Initialize global filter
     global_filter_init();
     global_distortion_init();
+#if defined (GLOBAL_FILTER_BENCHMARK)
+    cycle_counter_init();
+    printf("Global filter per block: float %lu cycles, fixed point %lu cycles\n",
+           global_filter_benchmark(false), global_filter_benchmark(true));
+#endif
     
     // Wait a little for AMY initialization to complete
     sleep_ms(100);
@@ -405,6 +306,7 @@ int main() {
 
     // Init i2s audio
     ap = init_audio();
+    audio_set_latency_profile(get_latency_profile());
 
     // Show a short intro animation. This will distract the user
     // while the hardware is calibrating.
@@ -427,21 +329,27 @@ int main() {
     update_patch();
     update_volume();
 
-    while(true) { // Main loop
-        // Perform any pending flash writes before audio operations
-        // to ensures Core1 is not reset while audio is being processed.
-        flash_write_task();
-        
-        directional_switch_task(); // Poll buttons
-
-        mpr121_task();
-
-        delay_ms(5); // Amy's idle function
-        display_task(&display); // Poll display updates after audio as display I2C can be such a block
-        
+    // Tasks in priority order. Audio is refilled as soon as an I2S buffer
+    // is free, everything else runs at a fixed rate.
+#if AUDIO_CORE1_ENGINE
+    // Core1 renders and outputs audio on its own, see audio_engine_loop()
+#else
+    scheduler_add(&audio_task);
+#endif
 #if defined (USE_MIDI)
-        tud_task(); // TinyUSB device task
+    scheduler_add(&usb_task);
+#endif
+    scheduler_add(&touch_task);
+    scheduler_add(&buttons_task);
+    scheduler_add(&display_refresh_task);
+    // Flash writes reset Core1, they only ever run between two audio blocks
+    scheduler_add(&flash_task);
+#if defined (SCHEDULER_STATS_PRINT_MS)
+    scheduler_add(&stats_task);
 #endif
+
+    while(true) { // Main loop
+        scheduler_run_once();
     }
     return 0;
 }
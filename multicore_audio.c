@@ -1,10 +1,71 @@
 #include "multicore_audio.h"
-#include "global_filter.h"
-#include "global_distortion.h"
+#include "string_inserts.h"
+#include "fx_chain.h"
+#include "render_channel.h"
+#include "audio_bus.h"
+#include "cycle_counter.h"
+#include "profiler.h"
+#include "synth.h"
+#include "state_data.h"
 #include <math.h>
+#include <string.h>
 
 extern struct audio_buffer_pool *ap;
 
+// In engine mode Core1 outputs its own blocks, there is nothing to hand over
+#define AUDIO_PIPELINED (AUDIO_PIPELINE_DEPTH > 0 && !AUDIO_CORE1_ENGINE)
+
+static render_channel_t render_channel;
+
+// Output latency profiles. The pool holds enough buffers for the deepest one,
+// those the current profile doesn't use are kept aside by the producer.
+static const uint8_t latency_buffers[LATENCY_PROFILE_COUNT] = {
+    [LATENCY_LOW]      = AUDIO_LATENCY_LOW_BUFFERS,
+    [LATENCY_BALANCED] = AUDIO_LATENCY_BALANCED_BUFFERS,
+    [LATENCY_SAFE]     = AUDIO_LATENCY_SAFE_BUFFERS,
+};
+static _Atomic uint8_t latency_profile = DEFAULT_LATENCY_PROFILE;
+static struct audio_buffer *reserve_buffers[AUDIO_LATENCY_SAFE_BUFFERS];
+static uint8_t reserve_count;
+
+// Set by Core0 to stop Core1 between two blocks (before a reset), acknowledged by Core1
+static _Atomic bool core1_park_requested;
+static _Atomic bool core1_parked;
+
+// Oscillators [0, split) are rendered by Core0, [split, AMY_OSCS) by Core1
+static render_stats_t render_stats = {
+    .split = AMY_OSCS / 2,
+};
+
+void get_render_stats(render_stats_t *stats) {
+    *stats = render_stats;
+}
+
+// Move the split point towards the core that finished first, so that
+// both cores complete their share of the oscillators at the same time.
+static void render_balance_update(uint32_t core0_cycles, uint32_t core1_cycles) {
+    render_stats.core0_cycles = core0_cycles;
+    render_stats.core1_cycles = core1_cycles;
+
+#if RENDER_BALANCE_ENABLED
+    uint32_t total = core0_cycles + core1_cycles;
+    uint32_t diff = (core0_cycles > core1_cycles) ? core0_cycles - core1_cycles : core1_cycles - core0_cycles;
+    if (total == 0 || diff < RENDER_BALANCE_MIN_DIFF_CYCLES) {
+        return;
+    }
+
+    // Step proportionally to the imbalance, but at least one oscillator
+    uint32_t step = (uint32_t)(((uint64_t)AMY_OSCS * diff) / (4 * (uint64_t)total));
+    if (step == 0) step = 1;
+
+    if (core0_cycles > core1_cycles) {
+        render_stats.split = (render_stats.split > step) ? render_stats.split - step : 0;
+    } else {
+        render_stats.split = (render_stats.split + step < AMY_OSCS) ? render_stats.split + step : AMY_OSCS;
+    }
+#endif
+}
+
 int32_t await_message_from_other_core() {
     uint32_t timeout_start = time_us_32();
     const uint32_t TIMEOUT_US = 100000;  // 100ms timeout
@@ -23,60 +84,356 @@ void send_message_to_other_core(int32_t t) {
     multicore_fifo_push_blocking(t);
 }
 
-void rp2040_fill_audio_buffer() {
-    amy_execute_deltas();
+// 32-bit bus the global effects run on. Only used by the core running the output stage.
+static bus_sample_t bus_block[AMY_BLOCK_SIZE * AMY_NCHANS];
+
+// Output stage: global effects, written into the I2S buffer.
+// block may alias samples, in which case the effects run in place.
+static void process_audio_block(const int16_t *block, int16_t *samples) {
+    if (block == NULL) {
+        // Fill with silence if AMY returns NULL
+        uint32_t copy_start = profiler_start();
+        memset(samples, 0, AMY_BLOCK_SIZE * AMY_NCHANS * sizeof(int16_t));
+        profiler_stop(PROFILE_STAGE_COPY, copy_start);
+        return;
+    }
     
-    // Send message to Core1 to start processing
-    multicore_fifo_push_blocking(32);
+    // Effects placed per string already ran before the mix
+    if (!fx_chain_mix_active()) {
+        if (block != samples) {
+            uint32_t copy_start = profiler_start();
+            memcpy(samples, block, AMY_BLOCK_SIZE * AMY_NCHANS * sizeof(int16_t));
+            profiler_stop(PROFILE_STAGE_COPY, copy_start);
+        }
+        return;
+    }
     
-    // Core0 renders first half of oscillators
-    amy_render(0, AMY_OSCS/2, 0);
+    // Widen once, run every effect on the bus, saturate once on the way out.
+    // Nothing clips or loses resolution between two effects.
+    uint32_t bus_start = profiler_start();
+    audio_bus_from_int16_block(block, bus_block, AMY_BLOCK_SIZE * AMY_NCHANS);
+    uint32_t bus_cycles = cycle_counter_elapsed(bus_start, profiler_start());
     
-    // Wait for Core1 to finish second half with timeout
-    uint32_t timeout_start = time_us_32();
-    const uint32_t TIMEOUT_US = 5000;  // 5ms timeout
+    fx_chain_process_mix(bus_block, AMY_BLOCK_SIZE);
     
-    while (!multicore_fifo_rvalid()) {
-        if (time_us_32() - timeout_start > TIMEOUT_US) {
-            break;
+    bus_start = profiler_start();
+    audio_bus_to_int16_block(bus_block, samples, AMY_BLOCK_SIZE * AMY_NCHANS);
+    profiler_record(PROFILE_STAGE_BUS, bus_cycles + cycle_counter_elapsed(bus_start, profiler_start()));
+}
+
+#if AUDIO_PIPELINED
+// I2S buffers holding mixed blocks, waiting for the output stage on Core1.
+// Core0 only advances the head, Core1 only advances the tail.
+static struct audio_buffer *pipeline_buffers[AUDIO_PIPELINE_DEPTH];
+static _Atomic uint32_t pipeline_head;
+static _Atomic uint32_t pipeline_tail;
+
+static void pipeline_push(const int16_t *block) {
+    // Wait for Core1 to free a slot. This is what paces Core0 in pipelined mode.
+    uint32_t head = atomic_load_explicit(&pipeline_head, memory_order_relaxed);
+    while (head - atomic_load_explicit(&pipeline_tail, memory_order_acquire) >= AUDIO_PIPELINE_DEPTH) {
+        render_channel_doorbell_wait();
+    }
+    
+    // AMY reuses its output block for the next render, so the mix has to be
+    // moved out before Core0 moves on. Park it in the I2S buffer it will be played from.
+    uint32_t take_start = profiler_start();
+    struct audio_buffer *buffer = take_audio_buffer(ap, true);
+    profiler_stop(PROFILE_STAGE_TAKE_BUFFER, take_start);
+    
+    uint32_t copy_start = profiler_start();
+    int16_t *samples = (int16_t *) buffer->buffer->bytes;
+    if (block != NULL) {
+        memcpy(samples, block, AMY_BLOCK_SIZE * AMY_NCHANS * sizeof(int16_t));
+    } else {
+        memset(samples, 0, AMY_BLOCK_SIZE * AMY_NCHANS * sizeof(int16_t));
+    }
+    profiler_stop(PROFILE_STAGE_COPY, copy_start);
+    pipeline_buffers[head % AUDIO_PIPELINE_DEPTH] = buffer;
+    
+    atomic_store_explicit(&pipeline_head, head + 1, memory_order_release);
+    render_channel_doorbell_ring();
+}
+
+// Called on Core1. Returns true if a block was sent to I2S.
+static bool pipeline_pop_and_output(void) {
+    uint32_t tail = atomic_load_explicit(&pipeline_tail, memory_order_relaxed);
+    if (tail == atomic_load_explicit(&pipeline_head, memory_order_acquire)) {
+        return false;
+    }
+    
+    // Effects run in place, the buffer already belongs to this block
+    struct audio_buffer *buffer = pipeline_buffers[tail % AUDIO_PIPELINE_DEPTH];
+    int16_t *samples = (int16_t *) buffer->buffer->bytes;
+    process_audio_block(samples, samples);
+    buffer->sample_count = AMY_BLOCK_SIZE;
+    give_audio_buffer(ap, buffer);
+    
+    atomic_store_explicit(&pipeline_tail, tail + 1, memory_order_release);
+    render_channel_doorbell_ring();
+    return true;
+}
+#else
+static void output_audio_block(const int16_t *block) {
+    uint32_t take_start = profiler_start();
+    struct audio_buffer *buffer = take_audio_buffer(ap, true);
+    profiler_stop(PROFILE_STAGE_TAKE_BUFFER, take_start);
+    process_audio_block(block, (int16_t *) buffer->buffer->bytes);
+    buffer->sample_count = AMY_BLOCK_SIZE;
+    give_audio_buffer(ap, buffer);
+}
+#endif
+
+// Cleared by Core1 if it finds AMY's per-core buffers unusable.
+// In engine mode Core1 renders everything itself, with Core0's buffers.
+static _Atomic bool core1_render_enabled = !AUDIO_CORE1_ENGINE;
+
+// Core1's share of a block into Core1's buffers: a range of oscillators, or
+// of strings through their inserts. Run by Core0 when it takes a job back.
+static void render_job(const render_job_t *job) {
+    if (job->string_end > job->string_start) {
+        string_inserts_render(job->string_start, job->string_end, 1);
+    } else {
+        amy_render(job->osc_start, job->osc_end, 1);
+    }
+}
+
+// amy_fill_buffer() still adds Core1's mix buffer once Core1 stopped
+// rendering. Silence it (if it is in RAM at all) so only Core0's part plays,
+// instead of whatever Core1 left there.
+static void core1_mix_buffer_silence(void) {
+    extern SAMPLE **fbl;
+    uintptr_t addr = (uintptr_t)fbl[1];
+    if (addr >= 0x20000000 && addr < 0x20080000) {
+        memset(fbl[1], 0, AMY_BLOCK_SIZE * AMY_NCHANS * sizeof(SAMPLE));
+    }
+}
+
+// A job Core1 was still rendering when its block was mixed (0: none)
+static uint32_t late_seq = 0;
+
+// Wait for Core1 to finish job seq. WFE sleeps until Core1 rings the doorbell
+// (or any interrupt fires). If Core1 does not pick the job up in time, Core0
+// takes it back and renders the range itself, so a hiccup costs CPU instead
+// of a half-rendered block. Returns true if Core1 completed the job.
+static bool render_wait_for_core1(uint32_t seq) {
+    uint32_t wait_start = time_us_32();
+    
+    while (!render_channel_is_done(&render_channel, seq)) {
+        uint32_t waited = time_us_32() - wait_start;
+        if (!render_channel_is_claimed(&render_channel, seq)) {
+            // Core1 has not started yet. If it claims the job in the meantime
+            // the cancel fails and we keep waiting for it.
+            if (waited > RENDER_CLAIM_TIMEOUT_US && render_channel_cancel(&render_channel, seq)) {
+                if (atomic_load_explicit(&core1_render_enabled, memory_order_relaxed)) {
+                    render_job(&render_channel.job);  // Ours again, Core1 won't touch it
+                } else {
+                    // Core1's buffers can't be trusted, this one block goes
+                    // without its share. The next ones are all Core0's.
+                    core1_mix_buffer_silence();
+                }
+                render_stats.degraded_blocks++;
+                return false;
+            }
+        } else if (waited > RENDER_TIMEOUT_US) {
+            // Core1 is stuck mid-render, mix what is there. It still writes
+            // its buffers and oscillators, the next block waits for it.
+            render_stats.late_blocks++;
+            late_seq = seq;
+            return false;
+        }
+        render_channel_doorbell_wait();
+    }
+    return true;
+}
+
+// Both cores render their share of the oscillators, then AMY mixes them.
+// With per-string inserts each core renders half of the strings instead,
+// the oscillator split then stays where it was.
+static int16_t *render_audio_block(uint32_t block_start, uint32_t deltas_end) {
+    static uint32_t block_index = 0;
+    
+    // Hand the upper part of the oscillators to Core1
+    // (Core1's buffers can't be trusted once it disabled itself, so Core0 takes everything)
+    bool core1_enabled = atomic_load_explicit(&core1_render_enabled, memory_order_relaxed);
+    bool per_string = string_inserts_active() && string_inserts_prepare();
+    uint16_t split = core1_enabled ? render_stats.split : AMY_OSCS;
+    uint8_t string_split = core1_enabled ? NUM_STRINGS / 2 : NUM_STRINGS;
+    uint32_t seq = 0;
+    if (core1_enabled) {
+        if (per_string) {
+            seq = render_channel_post_strings(&render_channel, block_index++, string_split, NUM_STRINGS);
+        } else {
+            seq = render_channel_post(&render_channel, block_index++, split, AMY_OSCS);
         }
-        sleep_us(10);
     }
     
-    if (multicore_fifo_rvalid()) {
-        multicore_fifo_pop_blocking(); // Consume response
+    // Core0 renders the lower part of the oscillators
+    uint32_t render_start = cycle_counter_now();
+    if (per_string) {
+        string_inserts_render(0, string_split, 0);
+    } else {
+        amy_render(0, split, 0);
     }
+    uint32_t render_end = cycle_counter_now();
+    
+    bool core1_done = core1_enabled && render_wait_for_core1(seq);
     
     // Get the final combined buffer
+    uint32_t mix_start = cycle_counter_now();
     int16_t *block = amy_fill_buffer();
+    uint32_t mix_end = cycle_counter_now();
     
-    // Apply global effects if enabled
-    if (block != NULL) {
-        global_distortion_process(block, AMY_BLOCK_SIZE);
-        global_filter_process(block, AMY_BLOCK_SIZE);
+    profiler_record(PROFILE_STAGE_DELTAS, cycle_counter_elapsed(block_start, deltas_end));
+    profiler_record(PROFILE_STAGE_RENDER_CORE0, cycle_counter_elapsed(render_start, render_end));
+    profiler_record(PROFILE_STAGE_RENDER_WAIT, cycle_counter_elapsed(render_end, mix_start));
+    profiler_record(PROFILE_STAGE_MIX, cycle_counter_elapsed(mix_start, mix_end));
+    
+#if AUDIO_PIPELINED
+    // Core1 runs the output stage for this block while both cores render the next one.
+    // Balance the whole per-core load, since only the wait is idle time.
+    uint32_t core0_cycles = cycle_counter_elapsed(block_start, render_end) + cycle_counter_elapsed(mix_start, mix_end);
+#else
+    // Only the render phase runs in parallel, so balance that alone
+    uint32_t core0_cycles = cycle_counter_elapsed(render_start, render_end);
+#endif
+    if (core1_done && !per_string) {
+        render_balance_update(core0_cycles, render_channel_job_cycles(&render_channel));
     }
     
-    struct audio_buffer *buffer = take_audio_buffer(ap, true);
-    if (!buffer) {
-        return;
+    synth_update_activity(block);
+    return block;
+}
+
+// Nothing is sounding: skip the oscillators and the global effects and leave
+// Core1 asleep. amy_render() clears a core's mix buffer before rendering, so an
+// empty range leaves silence in both, and the mix keeps AMY's clock running.
+static void render_silent_block(void) {
+    amy_render(0, 0, 0);
+    if (atomic_load_explicit(&core1_render_enabled, memory_order_relaxed)) {
+        amy_render(0, 0, 1);
+    }
+    amy_fill_buffer();
+    render_stats.silent_blocks++;
+}
+
+void audio_set_latency_profile(uint8_t profile) {
+    if (profile < LATENCY_PROFILE_COUNT) {
+        atomic_store_explicit(&latency_profile, profile, memory_order_relaxed);
+    }
+}
+
+// Samples already queued for output when a new block is rendered: every buffer
+// in use except the one being filled, plus the blocks waiting in the pipeline
+uint32_t audio_latency_samples(uint8_t profile) {
+    if (profile >= LATENCY_PROFILE_COUNT) {
+        return 0;
     }
+    return (latency_buffers[profile] - 1 + (AUDIO_PIPELINED ? AUDIO_PIPELINE_DEPTH : 0)) * AMY_BLOCK_SIZE;
+}
+
+uint32_t audio_latency_us(uint8_t profile) {
+    return (uint32_t)((uint64_t)audio_latency_samples(profile) * 1000000 / AMY_SAMPLE_RATE);
+}
+
+// Move buffers between the pool and the reserve until only those of the
+// current profile circulate. Runs on the core that takes buffers from the
+// pool, so a free buffer can't be taken from under it. Growing is immediate,
+// shrinking waits for buffers to come back from the DMA.
+static void latency_reserve_update(void) {
+    uint8_t profile = atomic_load_explicit(&latency_profile, memory_order_relaxed);
+    uint8_t target = AUDIO_LATENCY_SAFE_BUFFERS - latency_buffers[profile];
     
-    int16_t *samples = (int16_t *) buffer->buffer->bytes;
+    while (reserve_count > target) {
+        queue_free_audio_buffer(ap, reserve_buffers[--reserve_count]);
+    }
+    while (reserve_count < target) {
+        struct audio_buffer *buffer = take_audio_buffer(ap, false);
+        if (buffer == NULL) {
+            break;
+        }
+        reserve_buffers[reserve_count++] = buffer;
+    }
     
-    if (block != NULL) {
-        // Copy AMY audio data to I2S buffer
-        for (uint i = 0; i < AMY_BLOCK_SIZE * AMY_NCHANS; i++) {
-            samples[i] = block[i];
+    static uint8_t reported_profile = 0xFF;
+    if (profile != reported_profile && reserve_count == target) {
+        reported_profile = profile;
+        printf("Output latency %lu samples (%lu.%lu ms)\n", audio_latency_samples(profile),
+               audio_latency_us(profile) / 1000, audio_latency_us(profile) / 100 % 10);
+    }
+}
+
+// Before the next block touches AMY's state, let a late job finish: the
+// deltas and both renders would otherwise race Core1 on its oscillators
+// and on its mix buffer. If it still hasn't after another RENDER_TIMEOUT_US,
+// Core1 is taken as wedged and Core0 renders on its own from then on.
+static void render_wait_late_job(void) {
+    if (late_seq == 0) {
+        return;
+    }
+    if (!atomic_load_explicit(&core1_render_enabled, memory_order_relaxed)) {
+        // Given up on: if Core1 finishes after all, silence what it left
+        if (render_channel_is_done(&render_channel, late_seq)) {
+            core1_mix_buffer_silence();
+            late_seq = 0;
         }
-    } else {
-        // Fill with silence if AMY returns NULL
-        for (uint i = 0; i < AMY_BLOCK_SIZE * AMY_NCHANS; i++) {
-            samples[i] = 0;
+        return;
+    }
+    uint32_t wait_start = time_us_32();
+    while (!render_channel_is_done(&render_channel, late_seq)) {
+        if (time_us_32() - wait_start > RENDER_TIMEOUT_US) {
+            atomic_store_explicit(&core1_render_enabled, false, memory_order_relaxed);
+            core1_mix_buffer_silence();
+            return;
         }
+        render_channel_doorbell_wait();
+    }
+    late_seq = 0;
+}
+
+void rp2040_fill_audio_buffer() {
+    static bool cycle_counter_ready = false;
+    if (!cycle_counter_ready) {
+        cycle_counter_init();
+        cycle_counter_ready = true;
     }
+
+    render_wait_late_job();
+    uint32_t block_start = cycle_counter_now();
+    amy_execute_deltas();
+    uint32_t deltas_end = cycle_counter_now();
     
-    buffer->sample_count = AMY_BLOCK_SIZE;
-    give_audio_buffer(ap, buffer);
+    int16_t *block = NULL;  // NULL outputs a block of silence
+    if (synth_is_silent()) {
+        render_silent_block();
+    } else {
+        block = render_audio_block(block_start, deltas_end);
+    }
+
+#if defined (RENDER_STATS_PRINT_MS)
+    static uint32_t last_print = 0;
+    if (time_us_32() / 1000 - last_print > RENDER_STATS_PRINT_MS) {
+        last_print = time_us_32() / 1000;
+        printf("Render split %u/%u, core0 %lu cycles, core1 %lu cycles, %lu silent blocks\n",
+               render_stats.split, AMY_OSCS, render_stats.core0_cycles, render_stats.core1_cycles,
+               render_stats.silent_blocks);
+        printf("Core1 recovery: %lu blocks completed by core0, %lu late\n",
+               render_stats.degraded_blocks, render_stats.late_blocks);
+        audio_i2s_xrun_stats_t xruns;
+        audio_i2s_get_xrun_stats(&xruns);
+        printf("I2S underruns %lu, stalls %lu, overruns %lu, longest gap %lu us\n",
+               xruns.underruns, xruns.stalls, xruns.overruns, xruns.longest_gap_us);
+        profiler_report();
+    }
+#endif
+    
+#if AUDIO_PIPELINED
+    pipeline_push(block);
+#else
+    output_audio_block(block);
+#endif
+    latency_reserve_update();
+    profiler_stop(PROFILE_STAGE_BLOCK, block_start);
 }
 
 struct audio_buffer_pool *init_audio() {
@@ -92,7 +449,9 @@ struct audio_buffer_pool *init_audio() {
             .sample_stride = sizeof(int16_t) * AMY_NCHANS,
     };
 
-    struct audio_buffer_pool *producer_pool = audio_new_producer_pool(&producer_format, 3, AMY_BLOCK_SIZE);
+    // Blocks are rendered straight into these buffers and handed to the DMA as they are,
+    // so they also make up the whole I2S queue (one playing, the rest queued or being filled)
+    struct audio_buffer_pool *producer_pool = audio_new_producer_pool(&producer_format, AUDIO_BUFFER_COUNT, AMY_BLOCK_SIZE);
 
     bool __unused ok;
     const struct audio_format *output_format;
@@ -108,7 +467,8 @@ struct audio_buffer_pool *init_audio() {
         panic("PicoAudio: Unable to open audio device.\n");
     }
 
-    ok = audio_i2s_connect(producer_pool);
+    // No consumer buffers: pass-thru connection, no copy on the way to the DMA
+    ok = audio_i2s_connect_extra(producer_pool, false, 0, 0, NULL);
     assert(ok);
     
     audio_i2s_set_enabled(true);
@@ -116,6 +476,24 @@ struct audio_buffer_pool *init_audio() {
     return producer_pool;
 }
 
+// True when a block can be rendered and output without blocking
+bool audio_block_due(void) {
+    // Set by Core0 once I2S is up, possibly after the engine started on Core1
+    struct audio_buffer_pool *pool = *(struct audio_buffer_pool * volatile *)&ap;
+    if (pool == NULL) {
+        return false;
+    }
+#if AUDIO_PIPELINED
+    if (atomic_load_explicit(&pipeline_head, memory_order_relaxed) -
+        atomic_load_explicit(&pipeline_tail, memory_order_acquire) >= AUDIO_PIPELINE_DEPTH) {
+        return false;
+    }
+#endif
+    // Only this core takes from the free list, so once a buffer shows up
+    // it stays there until we take it. No need for the spin lock to peek.
+    return *(audio_buffer_t * volatile *)&pool->free_list != NULL;
+}
+
 // Delay while continuously filling audio buffers
 void delay_ms(uint32_t ms) {
     uint32_t start = amy_sysclock();
@@ -125,77 +503,145 @@ void delay_ms(uint32_t ms) {
     }
 }
 
+// Check once whether AMY's Core1 buffers look usable
+static bool core1_memory_valid(void) {
+    // Add null pointer checks
+    extern SAMPLE ** fbl;
+    extern SAMPLE ** per_osc_fb;
+    // Check algorithm scratch arrays
+    extern SAMPLE ***scratch;
+    
+    // Validate memory pointers (only check once per session)
+    static bool memory_checked = false;
+    static bool memory_valid = false;
+    
+    if (!memory_checked) {
+        // Check if pointers look valid (in reasonable memory range)
+        uintptr_t addr_fbl1 = (uintptr_t)fbl[1];
+        uintptr_t addr_per_osc_fb1 = (uintptr_t)per_osc_fb[1];
+        uintptr_t addr_scratch1 = (uintptr_t)scratch[1];
+        
+        // Valid RP2350 RAM range is roughly 0x20000000 to 0x20080000
+        bool fbl1_valid = (addr_fbl1 >= 0x20000000 && addr_fbl1 < 0x20080000);
+        bool per_osc_fb1_valid = (addr_per_osc_fb1 >= 0x20000000 && addr_per_osc_fb1 < 0x20080000);
+        bool scratch1_valid = (addr_scratch1 >= 0x20000000 && addr_scratch1 < 0x20080000);
+        
+        memory_valid = fbl1_valid && per_osc_fb1_valid && scratch1_valid;
+        memory_checked = true;
+    }
+    
+    return memory_valid;
+}
+
+// Called by Core0 before resetting Core1. Waits (up to 20ms) for Core1 to
+// stop between two blocks, so it isn't holding an I2S buffer or a render job.
+void audio_core1_park(void) {
+    atomic_store_explicit(&core1_park_requested, true, memory_order_release);
+    render_channel_doorbell_ring();
+    
+    uint32_t wait_start = time_us_32();
+    while (!atomic_load_explicit(&core1_parked, memory_order_acquire) &&
+           time_us_32() - wait_start < 20000) {
+        tight_loop_contents();
+    }
+}
+
+static void core1_park_if_requested(void) {
+    if (!atomic_load_explicit(&core1_park_requested, memory_order_acquire)) {
+        return;
+    }
+    atomic_store_explicit(&core1_parked, true, memory_order_release);
+    render_channel_doorbell_ring();
+    while (1) {
+        render_channel_doorbell_wait();  // Until Core0 resets this core
+    }
+}
+
+#if AUDIO_CORE1_ENGINE
+// Core1 runs the whole audio path on its own: commands from Core0, AMY,
+// global effects and the I2S output. Core0 never waits on audio.
+static void audio_engine_loop(void) {
+    // AMY mixes both per-core buffers, Core1's own stays empty from now on
+    if (core1_memory_valid()) {
+        amy_render(0, 0, 1);
+    }
+    
+    while (1) {
+        core1_park_if_requested();
+        
+        // Apply notes and settings at the start of the block they land in
+        synth_process_commands();
+        
+        if (!audio_block_due()) {
+            // Sleep until an I2S buffer is freed or Core0 posts a command
+            render_channel_doorbell_wait();
+            continue;
+        }
+        rp2040_fill_audio_buffer();
+    }
+}
+#endif
+
 // Core1 audio processing function
 void core1_main() {
+    cycle_counter_init();
+    
+    atomic_store_explicit(&core1_park_requested, false, memory_order_relaxed);
+    atomic_store_explicit(&core1_parked, false, memory_order_relaxed);
+
+    // Ignore any job posted before this core was (re)started
+    uint32_t last_seq = atomic_load_explicit(&render_channel.posted_seq, memory_order_acquire);
+    render_channel_complete(&render_channel, last_seq, 0);
+
     // Send ready signal to Core0
     multicore_fifo_push_blocking(99);
     
-    uint32_t message_count = 0;
+#if AUDIO_CORE1_ENGINE
+    audio_engine_loop();
+#else
+    uint32_t output_cycles = 0;
+    render_job_t job;
     
     while(1) {
-        // Wait for message from Core0
-        int32_t ret = multicore_fifo_pop_blocking();
+        core1_park_if_requested();
         
-        if (ret == 32) {
-            static uint32_t render_count = 0;
-            render_count++;
-            
-            
-            // Add null pointer checks
-            extern SAMPLE ** fbl;
-            extern SAMPLE ** per_osc_fb;
-            // Check algorithm scratch arrays
-            extern SAMPLE ***scratch;
-            
-            // Validate memory pointers (only check once per session)
-            static bool memory_checked = false;
-            static bool memory_valid = false;
-            
-            if (!memory_checked) {
-                // Check if pointers look valid (in reasonable memory range)
-                uintptr_t addr_fbl1 = (uintptr_t)fbl[1];
-                uintptr_t addr_per_osc_fb1 = (uintptr_t)per_osc_fb[1];
-                uintptr_t addr_scratch1 = (uintptr_t)scratch[1];
-                
-                // Valid RP2350 RAM range is roughly 0x20000000 to 0x20080000
-                bool fbl1_valid = (addr_fbl1 >= 0x20000000 && addr_fbl1 < 0x20080000);
-                bool per_osc_fb1_valid = (addr_per_osc_fb1 >= 0x20000000 && addr_per_osc_fb1 < 0x20080000);
-                bool scratch1_valid = (addr_scratch1 >= 0x20000000 && addr_scratch1 < 0x20080000);
-                
-                memory_valid = fbl1_valid && per_osc_fb1_valid && scratch1_valid;
-                memory_checked = true;
-                
-                // printf("Core1: Memory validation - fbl[1]:%s per_osc_fb[1]:%s scratch[1]:%s\n",
-                //        fbl1_valid ? "OK" : "BAD", 
-                //        per_osc_fb1_valid ? "OK" : "BAD",
-                //        scratch1_valid ? "OK" : "BAD");
-            }
-            
-            // Check if memory is valid
-            if (!memory_valid) {
-                static bool corruption_logged = false;
-                
-                if (!corruption_logged) {
-                    printf("Core1: ERROR - Invalid memory pointers detected! Core1 rendering disabled.\n");
-                    printf("Core1: System will continue with Core0-only audio rendering.\n");
-                    corruption_logged = true;
-                }
-                
-                // Send response immediately to avoid Core0 timeout
-                multicore_fifo_push_blocking(64);
+        // Render jobs come first, since Core0 is waiting for them
+        if (!render_channel_poll(&render_channel, &last_seq, &job)) {
+#if AUDIO_PIPELINED
+            uint32_t output_start = cycle_counter_now();
+            if (pipeline_pop_and_output()) {
+                output_cycles += cycle_counter_elapsed(output_start, cycle_counter_now());
                 continue;
             }
-            
-            // Render second half of oscillators
-            amy_render(AMY_OSCS/2, AMY_OSCS, 1);
-            
-            
-            // Send completion signal back to Core0
-            multicore_fifo_push_blocking(64);
-        } else {
-            printf("Core1: Unexpected message: %ld (expected 32)\n", ret);
+#endif
+            // Sleep until Core0 posts a job or an I2S buffer is freed
+            render_channel_doorbell_wait();
+            continue;
         }
         
-        message_count++;
+        // Check if memory is valid
+        if (!core1_memory_valid()) {
+            // Leave this job unclaimed. Core0 takes it back once it times out,
+            // and renders everything itself from the next block on.
+            atomic_store_explicit(&core1_render_enabled, false, memory_order_relaxed);
+            continue;
+        }
+        
+        // Core0 may have given up on this job and rendered it itself
+        if (!render_channel_claim(&render_channel, job.seq)) {
+            continue;
+        }
+        
+        // Render the requested range of oscillators, or of strings
+        uint32_t render_start = cycle_counter_now();
+        render_job(&job);
+        uint32_t render_cycles = cycle_counter_elapsed(render_start, cycle_counter_now());
+        profiler_record(PROFILE_STAGE_RENDER_CORE1, render_cycles);
+        
+        // Publish completion back to Core0, along with the output
+        // stage work done since the previous job
+        render_channel_complete(&render_channel, job.seq, render_cycles + output_cycles);
+        output_cycles = 0;
     }
+#endif
 }
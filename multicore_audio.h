@@ -16,12 +16,31 @@
 extern "C" {
 #endif
 
+typedef struct render_stats {
+    uint16_t split;             // First oscillator rendered by Core1
+    uint32_t core0_cycles;      // Core0 render time for the last block
+    uint32_t core1_cycles;      // Core1 render time for the last block
+    uint32_t silent_blocks;     // Blocks output as silence without rendering
+    uint32_t degraded_blocks;   // Blocks where Core0 took back Core1's job and rendered it
+    uint32_t late_blocks;       // Blocks mixed while Core1 was still rendering
+} render_stats_t;
+
 int32_t await_message_from_other_core();
 void send_message_to_other_core(int32_t t);
 void fill_audio_buffer();
 struct audio_buffer_pool *init_audio();
+void rp2040_fill_audio_buffer(void);
+bool audio_block_due(void);
 void delay_ms(uint32_t ms);
 void core1_main();
+void audio_core1_park(void);
+void get_render_stats(render_stats_t *stats);
+
+// Select a LATENCY_* output profile, applied by the audio producer over the next blocks
+void audio_set_latency_profile(uint8_t profile);
+// Buffered output latency of a profile
+uint32_t audio_latency_samples(uint8_t profile);
+uint32_t audio_latency_us(uint8_t profile);
 
 #ifdef __cplusplus
 }
@@ -0,0 +1,75 @@
+#include "profiler.h"
+
+#if PROFILER_ENABLED
+#include <stdio.h>
+
+#if (PROFILER_HISTORY & (PROFILER_HISTORY - 1)) != 0
+#error PROFILER_HISTORY must be a power of two
+#endif
+
+static const char *stage_names[PROFILE_STAGE_COUNT] = {
+    [PROFILE_STAGE_BLOCK]        = "block",
+    [PROFILE_STAGE_DELTAS]       = "deltas",
+    [PROFILE_STAGE_RENDER_CORE0] = "render core0",
+    [PROFILE_STAGE_RENDER_CORE1] = "render core1",
+    [PROFILE_STAGE_RENDER_WAIT]  = "render wait",
+    [PROFILE_STAGE_MIX]          = "mix",
+    [PROFILE_STAGE_DISTORTION]   = "distortion",
+    [PROFILE_STAGE_FILTER]       = "filter",
+    [PROFILE_STAGE_BUS]          = "bus",
+    [PROFILE_STAGE_COPY]         = "copy",
+    [PROFILE_STAGE_TAKE_BUFFER]  = "take buffer",
+};
+
+static uint32_t history[PROFILE_STAGE_COUNT][PROFILER_HISTORY];
+static volatile uint32_t recorded[PROFILE_STAGE_COUNT];
+
+void profiler_record(profile_stage_t stage, uint32_t cycles) {
+    uint32_t n = recorded[stage];
+    history[stage][n & (PROFILER_HISTORY - 1)] = cycles;
+    recorded[stage] = n + 1;
+}
+
+// Stats may mix in a sample recorded while this runs on the other core,
+// which is fine for profiling purposes.
+void profiler_get_stats(profile_stage_t stage, profiler_stats_t *stats) {
+    uint32_t n = recorded[stage];
+    if (n > PROFILER_HISTORY) n = PROFILER_HISTORY;
+
+    stats->count = n;
+    if (n == 0) {
+        stats->min = stats->avg = stats->max = 0;
+        return;
+    }
+
+    uint32_t min = UINT32_MAX, max = 0;
+    uint64_t sum = 0;
+    for (uint32_t i = 0; i < n; i++) {
+        uint32_t v = history[stage][i];
+        if (v < min) min = v;
+        if (v > max) max = v;
+        sum += v;
+    }
+    stats->min = min;
+    stats->avg = (uint32_t)(sum / n);
+    stats->max = max;
+}
+
+void profiler_reset(void) {
+    for (int i = 0; i < PROFILE_STAGE_COUNT; i++) {
+        recorded[i] = 0;
+    }
+}
+
+void profiler_report(void) {
+    printf("%-14s %10s %10s %10s (%s, last %d blocks)\n", "stage", "min", "avg", "max",
+           CYCLE_COUNTER_UNIT, PROFILER_HISTORY);
+    for (int i = 0; i < PROFILE_STAGE_COUNT; i++) {
+        profiler_stats_t stats;
+        profiler_get_stats((profile_stage_t)i, &stats);
+        if (stats.count == 0) continue;
+        printf("%-14s %10lu %10lu %10lu\n", stage_names[i],
+               (unsigned long)stats.min, (unsigned long)stats.avg, (unsigned long)stats.max);
+    }
+}
+#endif
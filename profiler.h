@@ -0,0 +1,76 @@
+#ifndef PROFILER_H_
+#define PROFILER_H_
+
+/* Per-stage cycle profiler for the audio block.
+ * Each stage keeps the last PROFILER_HISTORY durations in its own ring, so
+ * every stage has a single writer (the core that runs it) and no locking is
+ * needed. Min/avg/max are computed over the ring when stats are requested.
+ * With PROFILER_ENABLED set to 0 every call compiles to nothing.
+ * Only depends on cycle_counter.h, so it also runs in a host build.
+ */
+
+#include <stdint.h>
+#include "config.h"
+#include "cycle_counter.h"
+
+#ifndef PROFILER_ENABLED
+#define PROFILER_ENABLED            0
+#endif
+
+#ifndef PROFILER_HISTORY
+#define PROFILER_HISTORY            64  // Blocks per stage, must be a power of two
+#endif
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef enum {
+    PROFILE_STAGE_BLOCK,            // Whole rp2040_fill_audio_buffer() on core0
+    PROFILE_STAGE_DELTAS,           // amy_execute_deltas()
+    PROFILE_STAGE_RENDER_CORE0,     // amy_render() of core0's oscillators
+    PROFILE_STAGE_RENDER_CORE1,     // amy_render() of core1's oscillators
+    PROFILE_STAGE_RENDER_WAIT,      // Core0 waiting for core1 to finish its render
+    PROFILE_STAGE_MIX,              // amy_fill_buffer()
+    PROFILE_STAGE_DISTORTION,       // Distortion node of the effects chain, on the mix
+    PROFILE_STAGE_FILTER,           // Filter node of the effects chain, on the mix
+    PROFILE_STAGE_BUS,              // Converting to and from the 32-bit effects bus
+    PROFILE_STAGE_COPY,             // Copying the mixed block into an I2S buffer
+    PROFILE_STAGE_TAKE_BUFFER,      // Blocked in take_audio_buffer()
+    PROFILE_STAGE_COUNT
+} profile_stage_t;
+
+typedef struct profiler_stats {
+    uint32_t min;
+    uint32_t avg;
+    uint32_t max;
+    uint32_t count;                 // Samples the stats were computed from
+} profiler_stats_t;
+
+#if PROFILER_ENABLED
+void profiler_record(profile_stage_t stage, uint32_t cycles);
+void profiler_get_stats(profile_stage_t stage, profiler_stats_t *stats);
+void profiler_reset(void);
+void profiler_report(void);
+
+static inline uint32_t profiler_start(void) {
+    return cycle_counter_now();
+}
+
+static inline void profiler_stop(profile_stage_t stage, uint32_t start) {
+    profiler_record(stage, cycle_counter_elapsed(start, cycle_counter_now()));
+}
+#else
+static inline void profiler_record(profile_stage_t stage, uint32_t cycles) { (void)stage; (void)cycles; }
+static inline void profiler_get_stats(profile_stage_t stage, profiler_stats_t *stats) { (void)stage; *stats = (profiler_stats_t){0}; }
+static inline void profiler_reset(void) {}
+static inline void profiler_report(void) {}
+static inline uint32_t profiler_start(void) { return 0; }
+static inline void profiler_stop(profile_stage_t stage, uint32_t start) { (void)stage; (void)start; }
+#endif
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* PROFILER_H_ */
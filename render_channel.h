@@ -0,0 +1,178 @@
+#ifndef RENDER_CHANNEL_H_
+#define RENDER_CHANNEL_H_
+
+/* Single-producer/single-consumer render job channel between the two cores.
+ * Core0 (producer) posts a job descriptor and rings the doorbell, core1
+ * (consumer) renders the requested oscillator range and publishes the
+ * sequence number of the job it completed. No locks and no FIFO round trips:
+ * ownership of the descriptor is handed over through two sequence counters.
+ *
+ * Before rendering, the consumer claims the job. Until then the producer can
+ * cancel it and render the range itself, so exactly one side ever renders a
+ * given job, and a late reply is told apart by its sequence number.
+ *
+ * The header only depends on C11 atomics, so it also builds on a host machine.
+ * On the device the doorbell is WFE/SEV, on the host it degrades to a yield.
+ */
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdatomic.h>
+
+#if PICO_ON_DEVICE
+#include "hardware/sync.h"
+#define render_channel_doorbell_wait()  __wfe()
+#define render_channel_doorbell_ring()  __sev()
+#else
+#include <sched.h>
+#define render_channel_doorbell_wait()  sched_yield()
+#define render_channel_doorbell_ring()  ((void)0)
+#endif
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef struct render_job {
+    uint32_t seq;           // Sequence number of this job (never 0 once posted)
+    uint32_t block;         // Index of the audio block being rendered
+    uint16_t osc_start;     // First oscillator to render (inclusive)
+    uint16_t osc_end;       // Last oscillator to render (exclusive)
+    uint8_t string_start;   // With per-string inserts, strings [string_start, string_end)
+    uint8_t string_end;     // are rendered through them instead of the oscillator range
+} render_job_t;
+
+typedef struct render_channel {
+    render_job_t job;               // Only written by the producer while no job is pending
+    _Atomic uint32_t job_version;   // Odd while the producer writes job, see render_channel_poll()
+    _Atomic uint32_t posted_seq;    // Sequence number of the last job posted by the producer
+    _Atomic uint32_t done_seq;      // Sequence number of the last job completed by the consumer
+    _Atomic uint32_t claimed_seq;   // Sequence number of the last job claimed (consumer) or cancelled (producer)
+    uint32_t job_cycles;            // Time the consumer spent on the last completed job
+} render_channel_t;
+
+static inline void render_channel_init(render_channel_t *ch) {
+    ch->job.seq = 0;
+    ch->job.block = 0;
+    ch->job.osc_start = 0;
+    ch->job.osc_end = 0;
+    ch->job.string_start = 0;
+    ch->job.string_end = 0;
+    ch->job_cycles = 0;
+    atomic_store_explicit(&ch->job_version, 0, memory_order_relaxed);
+    atomic_store_explicit(&ch->posted_seq, 0, memory_order_relaxed);
+    atomic_store_explicit(&ch->claimed_seq, 0, memory_order_relaxed);
+    atomic_store_explicit(&ch->done_seq, 0, memory_order_release);
+}
+
+// Take ownership of job seq. Fails if it was already taken, or if a newer job
+// was (sequence numbers are compared with wrap around).
+static inline bool render_channel_take(render_channel_t *ch, uint32_t seq) {
+    uint32_t cur = atomic_load_explicit(&ch->claimed_seq, memory_order_relaxed);
+    while ((int32_t)(seq - cur) > 0) {
+        if (atomic_compare_exchange_weak_explicit(&ch->claimed_seq, &cur, seq,
+                                                  memory_order_acq_rel, memory_order_relaxed)) {
+            return true;
+        }
+    }
+    return false;
+}
+
+/* Producer side */
+
+static inline uint32_t render_channel_publish(render_channel_t *ch, uint32_t block, uint16_t osc_start, uint16_t osc_end,
+                                              uint8_t string_start, uint8_t string_end) {
+    uint32_t seq = atomic_load_explicit(&ch->posted_seq, memory_order_relaxed) + 1;
+    if (seq == 0) seq = 1;  // 0 means "nothing posted yet"
+    uint32_t version = atomic_load_explicit(&ch->job_version, memory_order_relaxed);
+    atomic_store_explicit(&ch->job_version, version + 1, memory_order_relaxed);
+    atomic_thread_fence(memory_order_release);
+    ch->job.seq = seq;
+    ch->job.block = block;
+    ch->job.osc_start = osc_start;
+    ch->job.osc_end = osc_end;
+    ch->job.string_start = string_start;
+    ch->job.string_end = string_end;
+    atomic_store_explicit(&ch->job_version, version + 2, memory_order_release);
+    atomic_store_explicit(&ch->posted_seq, seq, memory_order_release);
+    render_channel_doorbell_ring();
+    return seq;
+}
+
+// Post a new job. The previous job must have completed (or been abandoned).
+// Returns the sequence number to wait for.
+static inline uint32_t render_channel_post(render_channel_t *ch, uint32_t block,
+                                           uint16_t osc_start, uint16_t osc_end) {
+    return render_channel_publish(ch, block, osc_start, osc_end, 0, 0);
+}
+
+// Same with a range of strings, each rendered through its inserts
+static inline uint32_t render_channel_post_strings(render_channel_t *ch, uint32_t block,
+                                                   uint8_t string_start, uint8_t string_end) {
+    return render_channel_publish(ch, block, 0, 0, string_start, string_end);
+}
+
+static inline bool render_channel_is_done(render_channel_t *ch, uint32_t seq) {
+    return atomic_load_explicit(&ch->done_seq, memory_order_acquire) == seq;
+}
+
+static inline bool render_channel_is_claimed(render_channel_t *ch, uint32_t seq) {
+    return atomic_load_explicit(&ch->claimed_seq, memory_order_acquire) == seq;
+}
+
+// Take back a job the consumer has not claimed yet. On success the producer
+// owns the job and must render it itself, the consumer will skip it.
+static inline bool render_channel_cancel(render_channel_t *ch, uint32_t seq) {
+    return render_channel_take(ch, seq);
+}
+
+// Only meaningful once render_channel_is_done() returned true for the job
+static inline uint32_t render_channel_job_cycles(render_channel_t *ch) {
+    return ch->job_cycles;
+}
+
+/* Consumer side */
+
+// Returns true and copies the job if one newer than *last_seq is pending.
+// Once the producer cancelled a job it can post the next one while the
+// consumer still copies it: the version tells, and the copy is retried.
+static inline bool render_channel_poll(render_channel_t *ch, uint32_t *last_seq, render_job_t *job) {
+    uint32_t posted = atomic_load_explicit(&ch->posted_seq, memory_order_acquire);
+    if (posted == *last_seq) {
+        return false;
+    }
+    uint32_t version = atomic_load_explicit(&ch->job_version, memory_order_acquire);
+    *job = ch->job;
+    atomic_thread_fence(memory_order_acquire);
+    if ((version & 1) || job->seq != posted ||
+        atomic_load_explicit(&ch->job_version, memory_order_relaxed) != version) {
+        return false;   // The newer job's doorbell wakes the next poll
+    }
+    *last_seq = posted;
+    return true;
+}
+
+// Must succeed before rendering a polled job. If it fails the producer cancelled
+// the job, which must then be dropped without completing it.
+static inline bool render_channel_claim(render_channel_t *ch, uint32_t seq) {
+    return render_channel_take(ch, seq);
+}
+
+// Block (sleeping on the doorbell) until a new job is available.
+static inline void render_channel_wait(render_channel_t *ch, uint32_t *last_seq, render_job_t *job) {
+    while (!render_channel_poll(ch, last_seq, job)) {
+        render_channel_doorbell_wait();
+    }
+}
+
+static inline void render_channel_complete(render_channel_t *ch, uint32_t seq, uint32_t cycles) {
+    ch->job_cycles = cycles;
+    atomic_store_explicit(&ch->done_seq, seq, memory_order_release);
+    render_channel_doorbell_ring();
+}
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* RENDER_CHANNEL_H_ */
@@ -0,0 +1,99 @@
+#include "scheduler.h"
+#include "hardware/sync.h"
+
+static scheduler_task_t *tasks[SCHEDULER_MAX_TASKS];
+static uint8_t task_count;
+
+// time_us_32() wraps, compare through the signed difference
+static inline bool time_reached(uint32_t now, uint32_t t) {
+    return (int32_t)(now - t) >= 0;
+}
+
+void scheduler_add(scheduler_task_t *task) {
+    if (task_count >= SCHEDULER_MAX_TASKS) {
+        panic("Scheduler: too many tasks\n");
+    }
+    uint32_t now = time_us_32();
+    task->due = false;
+    task->due_us = now + task->period_us;
+    tasks[task_count++] = task;
+}
+
+static bool task_is_due(scheduler_task_t *task, uint32_t now) {
+    if (!task->due) {
+        if (task->period_us && time_reached(now, task->due_us)) {
+            // Keep the nominal due time, so lateness is measured from it
+            task->due = true;
+        } else if (task->ready && task->ready()) {
+            // Measured from when the scheduler noticed, which may be a little late
+            task->due = true;
+            task->due_us = now;
+        }
+    }
+    return task->due;
+}
+
+static void task_run(scheduler_task_t *task) {
+    uint32_t start = time_us_32();
+    task->run();
+    uint32_t end = time_us_32();
+
+    uint32_t run_us = end - start;
+    uint32_t latency_us = end - task->due_us;
+    task->runs++;
+    if (run_us > task->max_run_us) task->max_run_us = run_us;
+    if (latency_us > task->max_latency_us) task->max_latency_us = latency_us;
+    if (task->deadline_us && latency_us > task->deadline_us) {
+        task->overruns++;
+    }
+
+    task->due = false;
+    if (task->period_us) {
+        // Skip the periods that were missed altogether instead of bursting
+        task->due_us += task->period_us;
+        if (time_reached(end, task->due_us)) {
+            task->due_us = end + task->period_us;
+        }
+    }
+}
+
+void scheduler_run_once(void) {
+    uint32_t now = time_us_32();
+    uint32_t next_us = now + 1000000;
+
+    for (uint8_t i = 0; i < task_count; i++) {
+        scheduler_task_t *task = tasks[i];
+        if (task_is_due(task, now)) {
+            task_run(task);
+            return;
+        }
+        if (task->period_us && (int32_t)(task->due_us - next_us) < 0) {
+            next_us = task->due_us;
+        }
+    }
+
+    // Nothing due. Freeing an I2S buffer raises an event (SEV), which wakes
+    // ready() driven tasks, periodic ones are woken by the timeout.
+    int32_t sleep_us = (int32_t)(next_us - now);
+    if (sleep_us > 0) {
+        best_effort_wfe_or_timeout(make_timeout_time_us(sleep_us));
+    }
+}
+
+void scheduler_reset_stats(void) {
+    for (uint8_t i = 0; i < task_count; i++) {
+        tasks[i]->runs = 0;
+        tasks[i]->overruns = 0;
+        tasks[i]->max_latency_us = 0;
+        tasks[i]->max_run_us = 0;
+    }
+}
+
+void scheduler_report(void) {
+    printf("%-10s %8s %8s %12s %10s\n", "task", "runs", "overruns", "max latency", "max run");
+    for (uint8_t i = 0; i < task_count; i++) {
+        scheduler_task_t *task = tasks[i];
+        printf("%-10s %8lu %8lu %9lu us %7lu us\n", task->name,
+               task->runs, task->overruns, task->max_latency_us, task->max_run_us);
+    }
+}
@@ -0,0 +1,47 @@
+#ifndef SCHEDULER_H_
+#define SCHEDULER_H_
+
+#include "pico/stdlib.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Cooperative main loop scheduler.
+ * Tasks run to completion on Core0, in priority order (the order they were
+ * added in). A task is due when its period has elapsed, or when its ready()
+ * callback says so. After each task run the scan restarts from the top, so a
+ * high priority task never waits for more than one lower priority task.
+ */
+
+#define SCHEDULER_MAX_TASKS         8
+
+typedef struct scheduler_task {
+    const char *name;
+    void (*run)(void);
+    bool (*ready)(void);        // Optional, makes the task due whenever it returns true
+    uint32_t period_us;         // 0 = only run when ready()
+    uint32_t deadline_us;       // Time from becoming due to completion before it counts as an overrun
+
+    // Filled in by the scheduler
+    uint32_t due_us;            // When the task became due
+    bool due;
+    uint32_t runs;
+    uint32_t overruns;
+    uint32_t max_latency_us;    // Worst time from becoming due to completion
+    uint32_t max_run_us;        // Worst time spent in run()
+} scheduler_task_t;
+
+void scheduler_add(scheduler_task_t *task);
+
+// Run the highest priority due task, or sleep until something may be due.
+void scheduler_run_once(void);
+
+void scheduler_reset_stats(void);
+void scheduler_report(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* SCHEDULER_H_ */
@@ -81,8 +81,8 @@ void set_selection_up() {
             break;
         }
         case CTX_SETTINGS: {
-            selection_t valid[] = {SELECTION_SETTINGS_PLAYING_MODE, SELECTION_SETTINGS_LEFTHANDED, SELECTION_SETTINGS_VOLUME, SELECTION_SETTINGS_CONTRAST, SELECTION_SETTINGS_ADVANCED, SELECTION_SETTINGS_INFO, SELECTION_SETTINGS_BACK};
-            uint8_t count = 7;
+            selection_t valid[] = {SELECTION_SETTINGS_PLAYING_MODE, SELECTION_SETTINGS_LEFTHANDED, SELECTION_SETTINGS_VOLUME, SELECTION_SETTINGS_CONTRAST, SELECTION_SETTINGS_LATENCY, SELECTION_SETTINGS_ADVANCED, SELECTION_SETTINGS_INFO, SELECTION_SETTINGS_BACK};
+            uint8_t count = 8;
             for(uint8_t i = 0; i < count; i++) {
                 if(valid[i] == selection) {
                     selection = valid[(i - 1 + count) % count];
@@ -153,8 +153,8 @@ void set_selection_up() {
             break;
         }
         case CTX_FILTER: {
-            selection_t valid[] = {SELECTION_FILTER_ONOFF, SELECTION_FILTER_FREQ, SELECTION_FILTER_RESONANCE, SELECTION_FILTER_RESET, SELECTION_FILTER_BACK};
-            uint8_t count = 5;
+            selection_t valid[] = {SELECTION_FILTER_ONOFF, SELECTION_FILTER_TYPE, SELECTION_FILTER_FREQ, SELECTION_FILTER_RESONANCE, SELECTION_FILTER_WAH_DEPTH, SELECTION_FILTER_WAH_SPEED, SELECTION_FILTER_PLACEMENT, SELECTION_FILTER_RESET, SELECTION_FILTER_BACK};
+            uint8_t count = 9;
             for(uint8_t i = 0; i < count; i++) {
                 if(valid[i] == selection) {
                     selection = valid[(i - 1 + count) % count];
@@ -164,8 +164,8 @@ void set_selection_up() {
             break;
         }
         case CTX_DISTORTION: {
-            selection_t valid[] = {SELECTION_DISTORTION_ONOFF, SELECTION_DISTORTION_LEVEL, SELECTION_DISTORTION_GAIN, SELECTION_DISTORTION_RESET, SELECTION_DISTORTION_BACK};
-            uint8_t count = 5;
+            selection_t valid[] = {SELECTION_DISTORTION_ONOFF, SELECTION_DISTORTION_MODEL, SELECTION_DISTORTION_LEVEL, SELECTION_DISTORTION_GAIN, SELECTION_DISTORTION_QUALITY, SELECTION_DISTORTION_PLACEMENT, SELECTION_DISTORTION_ORDER, SELECTION_DISTORTION_RESET, SELECTION_DISTORTION_BACK};
+            uint8_t count = 9;
             for(uint8_t i = 0; i < count; i++) {
                 if(valid[i] == selection) {
                     selection = valid[(i - 1 + count) % count];
@@ -221,8 +221,8 @@ void set_selection_down() {
             break;
         }
         case CTX_SETTINGS: {
-            selection_t valid[] = {SELECTION_SETTINGS_PLAYING_MODE, SELECTION_SETTINGS_LEFTHANDED, SELECTION_SETTINGS_VOLUME, SELECTION_SETTINGS_CONTRAST, SELECTION_SETTINGS_ADVANCED, SELECTION_SETTINGS_INFO, SELECTION_SETTINGS_BACK};
-            uint8_t count = 7;
+            selection_t valid[] = {SELECTION_SETTINGS_PLAYING_MODE, SELECTION_SETTINGS_LEFTHANDED, SELECTION_SETTINGS_VOLUME, SELECTION_SETTINGS_CONTRAST, SELECTION_SETTINGS_LATENCY, SELECTION_SETTINGS_ADVANCED, SELECTION_SETTINGS_INFO, SELECTION_SETTINGS_BACK};
+            uint8_t count = 8;
             for(uint8_t i = 0; i < count; i++) {
                 if(valid[i] == selection) {
                     selection = valid[(i + 1) % count];
@@ -292,8 +292,8 @@ void set_selection_down() {
             break;
         }
         case CTX_FILTER: {
-            selection_t valid[] = {SELECTION_FILTER_ONOFF, SELECTION_FILTER_FREQ, SELECTION_FILTER_RESONANCE, SELECTION_FILTER_RESET, SELECTION_FILTER_BACK};
-            uint8_t count = 5;
+            selection_t valid[] = {SELECTION_FILTER_ONOFF, SELECTION_FILTER_TYPE, SELECTION_FILTER_FREQ, SELECTION_FILTER_RESONANCE, SELECTION_FILTER_WAH_DEPTH, SELECTION_FILTER_WAH_SPEED, SELECTION_FILTER_PLACEMENT, SELECTION_FILTER_RESET, SELECTION_FILTER_BACK};
+            uint8_t count = 9;
             for(uint8_t i = 0; i < count; i++) {
                 if(valid[i] == selection) {
                     selection = valid[(i + 1) % count];
@@ -303,8 +303,8 @@ void set_selection_down() {
             break;
         }
         case CTX_DISTORTION: {
-            selection_t valid[] = {SELECTION_DISTORTION_ONOFF, SELECTION_DISTORTION_LEVEL, SELECTION_DISTORTION_GAIN, SELECTION_DISTORTION_RESET, SELECTION_DISTORTION_BACK};
-            uint8_t count = 5;
+            selection_t valid[] = {SELECTION_DISTORTION_ONOFF, SELECTION_DISTORTION_MODEL, SELECTION_DISTORTION_LEVEL, SELECTION_DISTORTION_GAIN, SELECTION_DISTORTION_QUALITY, SELECTION_DISTORTION_PLACEMENT, SELECTION_DISTORTION_ORDER, SELECTION_DISTORTION_RESET, SELECTION_DISTORTION_BACK};
+            uint8_t count = 9;
             for(uint8_t i = 0; i < count; i++) {
                 if(valid[i] == selection) {
                     selection = valid[(i + 1) % count];
@@ -371,14 +371,6 @@ void set_fx(amy_fx_t fx, bool value){
         break;
         case DISTORTION:
             state_data.fx_distortion = value;
-            // Update global distortion enabled state
-            extern void global_distortion_set_enabled(bool enabled);
-            global_distortion_set_enabled(value);
-            // Configure distortion parameters when enabling (ensures parameters are set even after boot)
-            if (value) {
-                extern void config_global_distortion(float level, float gain);
-                config_global_distortion(get_distortion_level(), get_distortion_gain());
-            }
         break;
     }
     set_dirty(true);
@@ -442,6 +434,37 @@ void set_contrast_down() {
     }
 }
 
+/* Latency profile */
+// 0 - Low
+// 1 - Balanced
+// 2 - Safe
+
+uint8_t get_latency_profile() {
+    return state_data.latency_profile;
+}
+
+void set_latency_profile(uint8_t value) {
+    if (value >= LATENCY_PROFILE_COUNT) {
+        value = LATENCY_PROFILE_COUNT - 1;
+    }
+    state_data.latency_profile = value;
+    set_dirty(true);
+}
+
+void set_latency_profile_up() {
+    uint8_t profile = get_latency_profile();
+    if(profile < LATENCY_PROFILE_COUNT - 1) {
+        set_latency_profile(profile + 1);
+    }
+}
+
+void set_latency_profile_down() {
+    uint8_t profile = get_latency_profile();
+    if(profile > 0) {
+        set_latency_profile(profile - 1);
+    }
+}
+
 /* String pitch */
 
 uint8_t get_string_pitch(uint8_t string) {
@@ -575,6 +598,67 @@ void set_preset_selected(int8_t value) {
     state_data.preset_selected = value;
 }
 
+/* Defaults */
+
+void initialize_default_settings(void) {
+    // Settings not loaded, initialize state_data with default values
+    set_patch(DEFAULT_PATCH);
+
+    set_fx(REVERB, false);
+    set_fx(FILTER, false);
+    set_fx(CHORUS, false);
+    set_fx(ECHO, false);
+    set_fx(DISTORTION, false);
+    
+    // Initialize effect parameters with defaults
+    set_reverb_liveness(DIAPASONIX_REVERB_DEFAULT_LIVENESS);
+    set_reverb_damping(DIAPASONIX_REVERB_DEFAULT_DAMPING);
+    set_reverb_xover_hz(DIAPASONIX_REVERB_DEFAULT_XOVER_HZ);
+    
+    set_chorus_max_delay(DIAPASONIX_CHORUS_DEFAULT_MAX_DELAY);
+    set_chorus_lfo_freq(DIAPASONIX_CHORUS_DEFAULT_LFO_FREQ);
+    set_chorus_depth(DIAPASONIX_CHORUS_DEFAULT_MOD_DEPTH);
+    
+    set_echo_delay_ms(DIAPASONIX_ECHO_DEFAULT_DELAY_MS);
+    set_echo_feedback((float)DIAPASONIX_ECHO_DEFAULT_FEEDBACK);
+    set_echo_filter_coef((float)DIAPASONIX_ECHO_DEFAULT_FILTER_COEF);
+    
+    set_filter_type(DIAPASONIX_FILTER_DEFAULT_TYPE);
+    set_filter_freq_hz(DIAPASONIX_FILTER_DEFAULT_FREQ_HZ);
+    set_filter_resonance(DIAPASONIX_FILTER_DEFAULT_RESONANCE);
+    set_filter_wah_depth(DIAPASONIX_FILTER_DEFAULT_WAH_DEPTH);
+    set_filter_wah_speed(DIAPASONIX_FILTER_DEFAULT_WAH_SPEED);
+    set_filter_per_string(DIAPASONIX_FILTER_DEFAULT_PER_STRING);
+    
+    set_distortion_model(DIAPASONIX_DISTORTION_DEFAULT_MODEL);
+    set_distortion_level(DIAPASONIX_DISTORTION_DEFAULT_LEVEL);
+    set_distortion_gain(DIAPASONIX_DISTORTION_DEFAULT_GAIN);
+    set_distortion_oversampling(DIAPASONIX_DISTORTION_DEFAULT_OVERSAMPLING);
+    set_distortion_per_string(DIAPASONIX_DISTORTION_DEFAULT_PER_STRING);
+    set_fx_order(DIAPASONIX_FX_DEFAULT_ORDER);
+    
+    set_volume(DEFAULT_VOLUME); // 0-8 range, gets converted to AMY's 0-11.0 range
+    set_contrast(CONTRAST_AUTO); // Automatic dimming of display brightness
+    set_latency_profile(DEFAULT_LATENCY_PROFILE);
+
+    set_string_pitch(0, DEFAULT_STRING_PITCH_0); // G3
+    set_string_pitch(1, DEFAULT_STRING_PITCH_1); // D3
+    set_string_pitch(2, DEFAULT_STRING_PITCH_2); // A2
+    set_string_pitch(3, DEFAULT_STRING_PITCH_3); // E2
+
+    set_playing_mode(false); // Start in tapping mode
+    set_lefthanded(false);
+    
+    set_preset_selected(-1); // No preset selected initially
+    
+    // Initialize advanced timing parameters with defaults
+    set_state_snapshot_window_ms(STATE_SNAPSHOT_WINDOW_MS);
+    set_fret_stale_timeout_ms(FRET_STALE_TIMEOUT_MS);
+    set_fret_very_recent_threshold_ms(FRET_VERY_RECENT_THRESHOLD_MS);
+    set_fret_post_strum_threshold_ms(FRET_POST_STRUM_THRESHOLD_MS);
+    set_fret_release_delay_ms(FRET_RELEASE_DELAY_MS);
+}
+
 /* Utilities and railroad stations */
 
 uint8_t get_random_u8() {
@@ -801,6 +885,27 @@ void reset_echo_fx() {
 
 /* Filter parameters */
 
+uint8_t get_filter_type() {
+    return state_data.filter_type;
+}
+
+void set_filter_type(uint8_t value) {
+    if (value >= FILTER_TYPE_COUNT) {
+        value = DIAPASONIX_FILTER_DEFAULT_TYPE;
+    }
+    state_data.filter_type = value;
+    set_dirty(true);
+}
+
+// Cycles through the types, wrapping around
+void set_filter_type_up() {
+    set_filter_type((get_filter_type() + 1) % FILTER_TYPE_COUNT);
+}
+
+void set_filter_type_down() {
+    set_filter_type((get_filter_type() + FILTER_TYPE_COUNT - 1) % FILTER_TYPE_COUNT);
+}
+
 float get_filter_freq_hz() {
     return state_data.filter_freq_hz;
 }
@@ -849,13 +954,99 @@ void set_filter_resonance_down() {
     set_filter_resonance(val - 0.1f);
 }
 
+uint8_t get_filter_wah_depth() {
+    return state_data.filter_wah_depth;
+}
+
+void set_filter_wah_depth(uint8_t value) {
+    if (value > DIAPASONIX_FILTER_WAH_DEPTH_MAX) value = DIAPASONIX_FILTER_WAH_DEPTH_MAX;
+    state_data.filter_wah_depth = value;
+    set_dirty(true);
+}
+
+void set_filter_wah_depth_up() {
+    uint8_t depth = get_filter_wah_depth();
+    if (depth < DIAPASONIX_FILTER_WAH_DEPTH_MAX) {
+        set_filter_wah_depth(depth + 1);
+    }
+}
+
+void set_filter_wah_depth_down() {
+    uint8_t depth = get_filter_wah_depth();
+    if (depth > 0) {
+        set_filter_wah_depth(depth - 1);
+    }
+}
+
+uint8_t get_filter_wah_speed() {
+    return state_data.filter_wah_speed;
+}
+
+void set_filter_wah_speed(uint8_t value) {
+    if (value >= FILTER_WAH_SPEED_COUNT) value = DIAPASONIX_FILTER_DEFAULT_WAH_SPEED;
+    state_data.filter_wah_speed = value;
+    set_dirty(true);
+}
+
+void set_filter_wah_speed_up() {
+    uint8_t speed = get_filter_wah_speed();
+    if (speed < FILTER_WAH_SPEED_COUNT - 1) {
+        set_filter_wah_speed(speed + 1);
+    }
+}
+
+void set_filter_wah_speed_down() {
+    uint8_t speed = get_filter_wah_speed();
+    if (speed > 0) {
+        set_filter_wah_speed(speed - 1);
+    }
+}
+
+bool get_filter_per_string() {
+    return state_data.filter_per_string;
+}
+
+void set_filter_per_string(bool value) {
+    state_data.filter_per_string = value;
+    set_dirty(true);
+}
+
+void toggle_filter_per_string() {
+    set_filter_per_string(!get_filter_per_string());
+}
+
 void reset_filter_fx() {
+    set_filter_type(DIAPASONIX_FILTER_DEFAULT_TYPE);
     set_filter_freq_hz(DIAPASONIX_FILTER_DEFAULT_FREQ_HZ);
     set_filter_resonance(DIAPASONIX_FILTER_DEFAULT_RESONANCE);
+    set_filter_wah_depth(DIAPASONIX_FILTER_DEFAULT_WAH_DEPTH);
+    set_filter_wah_speed(DIAPASONIX_FILTER_DEFAULT_WAH_SPEED);
+    set_filter_per_string(DIAPASONIX_FILTER_DEFAULT_PER_STRING);
 }
 
 /* Distortion parameters */
 
+uint8_t get_distortion_model() {
+    return state_data.distortion_model;
+}
+
+void set_distortion_model(uint8_t value) {
+    if (value >= DISTORTION_MODEL_COUNT) {
+        value = DIAPASONIX_DISTORTION_DEFAULT_MODEL;
+    }
+    state_data.distortion_model = value;
+    set_dirty(true);
+}
+
+// Cycles through the models, wrapping around
+void set_distortion_model_up() {
+    set_distortion_model((get_distortion_model() + 1) % DISTORTION_MODEL_COUNT);
+}
+
+void set_distortion_model_down() {
+    set_distortion_model((get_distortion_model() + DISTORTION_MODEL_COUNT - 1) % DISTORTION_MODEL_COUNT);
+}
+
 float get_distortion_level() {
     return state_data.distortion_level;
 }
@@ -866,9 +1057,6 @@ void set_distortion_level(float value) {
     if (value > 1.0f) value = 1.0f;
     state_data.distortion_level = value;
     set_dirty(true);
-    // Update global distortion configuration
-    extern void config_global_distortion(float level, float gain);
-    config_global_distortion(value, get_distortion_gain());
 }
 
 void set_distortion_level_up() {
@@ -891,9 +1079,6 @@ void set_distortion_gain(float value) {
     if (value > 20.0f) value = 20.0f;
     state_data.distortion_gain = value;
     set_dirty(true);
-    // Update global distortion configuration
-    extern void config_global_distortion(float level, float gain);
-    config_global_distortion(get_distortion_level(), value);
 }
 
 void set_distortion_gain_up() {
@@ -906,9 +1091,64 @@ void set_distortion_gain_down() {
     set_distortion_gain(val - 1.0f);  // Decrement by 1.0 internally (0.1 in UI)
 }
 
+uint8_t get_distortion_oversampling() {
+    return state_data.distortion_oversampling;
+}
+
+void set_distortion_oversampling(uint8_t value) {
+    if (value >= DISTORTION_OVERSAMPLE_COUNT) value = DIAPASONIX_DISTORTION_DEFAULT_OVERSAMPLING;
+    state_data.distortion_oversampling = value;
+    set_dirty(true);
+}
+
+void set_distortion_oversampling_up() {
+    uint8_t oversampling = get_distortion_oversampling();
+    if (oversampling < DISTORTION_OVERSAMPLE_COUNT - 1) {
+        set_distortion_oversampling(oversampling + 1);
+    }
+}
+
+void set_distortion_oversampling_down() {
+    uint8_t oversampling = get_distortion_oversampling();
+    if (oversampling > 0) {
+        set_distortion_oversampling(oversampling - 1);
+    }
+}
+
+bool get_distortion_per_string() {
+    return state_data.distortion_per_string;
+}
+
+void set_distortion_per_string(bool value) {
+    state_data.distortion_per_string = value;
+    set_dirty(true);
+}
+
+void toggle_distortion_per_string() {
+    set_distortion_per_string(!get_distortion_per_string());
+}
+
+uint8_t get_fx_order() {
+    return state_data.fx_order;
+}
+
+void set_fx_order(uint8_t value) {
+    if (value >= FX_ORDER_COUNT) value = DIAPASONIX_FX_DEFAULT_ORDER;
+    state_data.fx_order = value;
+    set_dirty(true);
+}
+
+void toggle_fx_order() {
+    set_fx_order((get_fx_order() + 1) % FX_ORDER_COUNT);
+}
+
 void reset_distortion_fx() {
+    set_distortion_model(DIAPASONIX_DISTORTION_DEFAULT_MODEL);
     set_distortion_level(DIAPASONIX_DISTORTION_DEFAULT_LEVEL);
     set_distortion_gain(DIAPASONIX_DISTORTION_DEFAULT_GAIN);
+    set_distortion_oversampling(DIAPASONIX_DISTORTION_DEFAULT_OVERSAMPLING);
+    set_distortion_per_string(DIAPASONIX_DISTORTION_DEFAULT_PER_STRING);
+    set_fx_order(DIAPASONIX_FX_DEFAULT_ORDER);
 }
 
 /* Advanced timing parameters */
@@ -53,6 +53,7 @@ typedef enum selection {
     SELECTION_SETTINGS_LEFTHANDED,
     SELECTION_SETTINGS_VOLUME,
     SELECTION_SETTINGS_CONTRAST,
+    SELECTION_SETTINGS_LATENCY,
     SELECTION_SETTINGS_ADVANCED,
     SELECTION_SETTINGS_INFO,
     SELECTION_SETTINGS_BACK,
@@ -102,15 +103,23 @@ typedef enum selection {
 
     /* Filter screen */
     SELECTION_FILTER_ONOFF,
+    SELECTION_FILTER_TYPE,
     SELECTION_FILTER_FREQ,
     SELECTION_FILTER_RESONANCE,
+    SELECTION_FILTER_WAH_DEPTH,
+    SELECTION_FILTER_WAH_SPEED,
+    SELECTION_FILTER_PLACEMENT,
     SELECTION_FILTER_RESET,
     SELECTION_FILTER_BACK,
 
     /* Distortion screen */
     SELECTION_DISTORTION_ONOFF,
+    SELECTION_DISTORTION_MODEL,
     SELECTION_DISTORTION_LEVEL,
     SELECTION_DISTORTION_GAIN,
+    SELECTION_DISTORTION_QUALITY,
+    SELECTION_DISTORTION_PLACEMENT,
+    SELECTION_DISTORTION_ORDER,
     SELECTION_DISTORTION_RESET,
     SELECTION_DISTORTION_BACK,
 
@@ -144,12 +153,21 @@ typedef struct state_data {
     
     float filter_freq_hz;      // Filter cutoff frequency in Hz
     float filter_resonance;    // Filter Q factor (resonance)
+    uint8_t filter_type;       // Filter response and slope (FILTER_TYPE_*)
+    uint8_t filter_wah_depth;  // Auto-wah cutoff sweep in half octaves, 0 = off
+    uint8_t filter_wah_speed;  // Auto-wah envelope speed (FILTER_WAH_*)
+    bool filter_per_string;    // One filter per string instead of one on the mix
     
+    uint8_t distortion_model;  // Distortion curve or crusher (DISTORTION_MODEL_*)
     float distortion_level;    // Distortion amount (0.0 to 1.0)
     float distortion_gain;     // Distortion drive/gain (10.0 to 20.0 internally, displayed as 1.0 to 2.0)
+    uint8_t distortion_oversampling; // Distortion quality (DISTORTION_OVERSAMPLE_*)
+    bool distortion_per_string;      // One distortion per string instead of one on the mix
+    uint8_t fx_order;                // Order of the distortion and the filter (FX_ORDER_*)
 
     uint8_t volume;
     uint8_t contrast;          // Value to control the SSD1306 display brightness (aka "contrast")
+    uint8_t latency_profile;   // Output buffering, trades latency for headroom (LATENCY_*)
 
     uint8_t string_pitch[NUM_STRINGS];
     int16_t capo;
@@ -170,6 +188,50 @@ typedef struct state_data {
     int8_t preset_selected;         // Selected preset number (-1 = null, 0-3 = preset 0-3)
 } state_data_t;
 
+#define CONTRAST_MIN    0
+#define CONTRAST_MED    1
+#define CONTRAST_MAX    2
+#define CONTRAST_AUTO   3
+
+#define LATENCY_LOW             0
+#define LATENCY_BALANCED        1
+#define LATENCY_SAFE            2
+#define LATENCY_PROFILE_COUNT   3
+
+// Global filter responses, each with a 24 dB/oct (two biquads) and a 12 dB/oct slope
+#define FILTER_TYPE_LPF24       0
+#define FILTER_TYPE_LPF12       1
+#define FILTER_TYPE_HPF24       2
+#define FILTER_TYPE_HPF12       3
+#define FILTER_TYPE_BPF24       4
+#define FILTER_TYPE_BPF12       5
+#define FILTER_TYPE_NOTCH24     6
+#define FILTER_TYPE_NOTCH12     7
+#define FILTER_TYPE_COUNT       8
+
+#define FILTER_WAH_FAST         0
+#define FILTER_WAH_MEDIUM       1
+#define FILTER_WAH_SLOW         2
+#define FILTER_WAH_SPEED_COUNT  3
+
+#define DISTORTION_MODEL_HARSH  0   // Cubic shaper and hard clip
+#define DISTORTION_MODEL_SOFT   1   // Smooth, tanh-like soft clip
+#define DISTORTION_MODEL_TUBE   2   // Biased soft clip, adds even harmonics
+#define DISTORTION_MODEL_FUZZ   3   // Hot asymmetric hard clip
+#define DISTORTION_MODEL_CRUSH  4   // Bit depth and sample rate reduction
+#define DISTORTION_MODEL_COUNT  5
+
+// Rate the global distortion runs at, 1x (off), 2x or 4x the sample rate
+#define DISTORTION_OVERSAMPLE_OFF   0
+#define DISTORTION_OVERSAMPLE_2X    1
+#define DISTORTION_OVERSAMPLE_4X    2
+#define DISTORTION_OVERSAMPLE_COUNT 3
+
+// Order of the global effects after AMY (fx_chain.c)
+#define FX_ORDER_DISTORTION_FILTER  0
+#define FX_ORDER_FILTER_DISTORTION  1
+#define FX_ORDER_COUNT              2
+
 typedef enum amy_fx {
     REVERB,
     FILTER,
@@ -247,7 +309,12 @@ void set_echo_filter_coef_up();
 void set_echo_filter_coef_down();
 void reset_echo_fx();
 
-// Filter parameters (LPF24 only)
+// Filter parameters
+uint8_t get_filter_type();
+void set_filter_type(uint8_t value);
+void set_filter_type_up();
+void set_filter_type_down();
+
 float get_filter_freq_hz();
 void set_filter_freq_hz(float value);
 void set_filter_freq_hz_up();
@@ -257,9 +324,28 @@ float get_filter_resonance();
 void set_filter_resonance(float value);
 void set_filter_resonance_up();
 void set_filter_resonance_down();
+
+uint8_t get_filter_wah_depth();
+void set_filter_wah_depth(uint8_t value);
+void set_filter_wah_depth_up();
+void set_filter_wah_depth_down();
+
+uint8_t get_filter_wah_speed();
+void set_filter_wah_speed(uint8_t value);
+void set_filter_wah_speed_up();
+void set_filter_wah_speed_down();
+
+bool get_filter_per_string();
+void set_filter_per_string(bool value);
+void toggle_filter_per_string();
 void reset_filter_fx();
 
 // Distortion parameters
+uint8_t get_distortion_model();
+void set_distortion_model(uint8_t value);
+void set_distortion_model_up();
+void set_distortion_model_down();
+
 float get_distortion_level();
 void set_distortion_level(float value);
 void set_distortion_level_up();
@@ -269,6 +355,19 @@ float get_distortion_gain();
 void set_distortion_gain(float value);
 void set_distortion_gain_up();
 void set_distortion_gain_down();
+
+uint8_t get_distortion_oversampling();
+void set_distortion_oversampling(uint8_t value);
+void set_distortion_oversampling_up();
+void set_distortion_oversampling_down();
+
+bool get_distortion_per_string();
+void set_distortion_per_string(bool value);
+void toggle_distortion_per_string();
+
+uint8_t get_fx_order();
+void set_fx_order(uint8_t value);
+void toggle_fx_order();
 void reset_distortion_fx();
 
 uint8_t get_volume();
@@ -281,6 +380,11 @@ void set_contrast(uint8_t value);
 void set_contrast_up();
 void set_contrast_down();
 
+uint8_t get_latency_profile();
+void set_latency_profile(uint8_t value);
+void set_latency_profile_up();
+void set_latency_profile_down();
+
 uint8_t get_string_pitch(uint8_t string);
 void set_string_pitch(uint8_t string, uint8_t value);
 void set_string_pitch_up(uint8_t string);
@@ -337,6 +441,9 @@ void set_fret_release_delay_ms_down();
 
 void reset_advanced_timing();
 
+// Initialize state_data with default values, used when no settings are stored on flash
+void initialize_default_settings(void);
+
 uint8_t get_random_u8();
 
 #ifdef __cplusplus
@@ -0,0 +1,98 @@
+#include "string_inserts.h"
+#include "amy.h"
+#include "config.h"
+#include "audio_bus.h"
+#include "global_distortion.h"
+#include "global_filter.h"
+#include "fx_chain.h"
+#include "clock_config.h"
+#include "synth.h"
+#include <string.h>
+
+// AMY's per-core mix buffers, a channel after the other
+extern SAMPLE **fbl;
+
+// Spreading a string to the interleaved bus, adding it up and back
+#define CYCLES_PER_FRAME_STRING 8
+
+// With the engine on Core1, a single core renders every string.
+// Otherwise each core takes half of them.
+#if AUDIO_CORE1_ENGINE
+#define STRINGS_PER_CORE    NUM_STRINGS
+#else
+#define STRINGS_PER_CORE    ((NUM_STRINGS + 1) / 2)
+#endif
+
+// Written by the core that owns AMY before it posts the block to Core1
+static uint16_t osc_start[NUM_STRINGS];
+static uint16_t osc_end[NUM_STRINGS];
+
+// One set per core, both may render strings at once
+static bus_sample_t string_block[2][AMY_BLOCK_SIZE * AMY_NCHANS];
+static bus_sample_t strings_sum[2][AMY_BLOCK_SIZE * AMY_NCHANS];
+
+bool string_inserts_active(void) {
+    return fx_chain_strings_active();
+}
+
+bool string_inserts_prepare(void) {
+    return synth_string_osc_ranges(osc_start, osc_end);
+}
+
+void string_inserts_render(uint8_t first, uint8_t last, uint8_t core) {
+    core &= 1;
+    bus_sample_t *block = string_block[core];
+    bus_sample_t *sum = strings_sum[core];
+    memset(sum, 0, sizeof(strings_sum[core]));
+
+    for (uint8_t s = first; s < last && s < NUM_STRINGS; s++) {
+        // amy_render() clears the buffer first, it only holds this string
+        amy_render(osc_start[s], osc_end[s], core);
+        const SAMPLE *rendered = fbl[core];
+        for (uint16_t i = 0; i < AMY_BLOCK_SIZE; i++) {
+            for (uint8_t c = 0; c < AMY_NCHANS; c++) {
+                block[AMY_NCHANS * i + c] = rendered[c * AMY_BLOCK_SIZE + i];
+            }
+        }
+
+        fx_chain_process_string(s, core, block, AMY_BLOCK_SIZE);
+
+        for (uint16_t i = 0; i < AMY_BLOCK_SIZE * AMY_NCHANS; i++) {
+            sum[i] += block[i];
+        }
+    }
+
+    // The bus has the same scaling as AMY's SAMPLE
+    SAMPLE *mix = fbl[core];
+    for (uint16_t i = 0; i < AMY_BLOCK_SIZE; i++) {
+        for (uint8_t c = 0; c < AMY_NCHANS; c++) {
+            mix[c * AMY_BLOCK_SIZE + i] = sum[AMY_NCHANS * i + c];
+        }
+    }
+}
+
+uint8_t string_inserts_load_percent(void) {
+    uint32_t cycles = 0;
+    if (global_distortion_is_per_string()) {
+        cycles += global_distortion_cycles_estimate();
+    }
+    if (global_filter_is_per_string()) {
+        cycles += global_filter_cycles_estimate();
+    }
+    if (cycles == 0) {
+        return 0;
+    }
+    cycles += CYCLES_PER_FRAME_STRING * AMY_BLOCK_SIZE;
+
+    const clock_profile_t *profile = clock_profile_for_rate(AMY_SAMPLE_RATE);
+    if (profile == NULL) {
+        return 0;
+    }
+    uint64_t block_cycles = (uint64_t)clock_profile_sys_hz(profile) * AMY_BLOCK_SIZE / AMY_SAMPLE_RATE;
+    uint64_t percent = (uint64_t)cycles * STRINGS_PER_CORE * 100 / block_cycles;
+    return percent > UINT8_MAX ? UINT8_MAX : (uint8_t)percent;
+}
+
+bool string_inserts_over_budget(void) {
+    return string_inserts_load_percent() > STRING_INSERTS_BUDGET_PERCENT;
+}
@@ -0,0 +1,45 @@
+#ifndef STRING_INSERTS_H_
+#define STRING_INSERTS_H_
+
+/* Per-string inserts.
+ * Each string is its own AMY instrument, so its oscillators can be rendered
+ * apart from the other strings'. With the distortion or the filter placed
+ * per string, a core renders its strings one at a time: AMY renders the
+ * string into the core's mix buffer, the string's inserts run on it, and it
+ * is added to the strings before it. The sum goes back into the buffer, and
+ * amy_fill_buffer() mixes the cores and runs AMY's own effects on it as usual.
+ *
+ * A power chord then distorts string by string instead of intermodulating,
+ * and the auto-wah follows each string's own dynamics. Every insert costs a
+ * full instance of the effect, see string_inserts_load_percent().
+ */
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// True when an enabled effect is placed per string
+bool string_inserts_active(void);
+
+// Fetch the strings' oscillators for this block, on the core that owns AMY,
+// before any string_inserts_render(). False if they aren't known yet, the
+// block is then rendered the usual way.
+bool string_inserts_prepare(void);
+
+// Render strings [first, last) through their inserts into AMY's mix buffer of core
+void string_inserts_render(uint8_t first, uint8_t last, uint8_t core);
+
+// Cost model: estimated share of a block's time (percent, of the busiest
+// core) the inserts of all strings take with the current settings, and
+// whether it is over STRING_INSERTS_BUDGET_PERCENT
+uint8_t string_inserts_load_percent(void);
+bool string_inserts_over_budget(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* STRING_INSERTS_H_ */
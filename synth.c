@@ -0,0 +1,391 @@
+#include "synth.h"
+#include "config.h"
+#include "state_data.h"
+#include "global_filter.h"
+#include "global_distortion.h"
+#include "fx_chain.h"
+#include <stddef.h>
+
+// AMY's rate is fixed when it is compiled, CMakeLists.txt passes it AUDIO_SAMPLE_RATE
+#if AMY_SAMPLE_RATE != AUDIO_SAMPLE_RATE
+#error "AMY was built for a different rate than AUDIO_SAMPLE_RATE"
+#endif
+
+// MIDI output only exists on the device. Host builds share this file
+// with the firmware but have no USB stack.
+#if defined (USE_MIDI) && PICO_ON_DEVICE
+#define SYNTH_MIDI_OUT 1
+#include "tusb.h"
+#else
+#define SYNTH_MIDI_OUT 0
+#endif
+
+#if AUDIO_CORE1_ENGINE
+#include <stdatomic.h>
+#include "pico/stdlib.h"
+#include "hardware/sync.h"
+#endif
+
+#define NOTE_VELOCITY 0.5f
+
+typedef enum {
+    SYNTH_CMD_NOTE_ON,
+    SYNTH_CMD_NOTE_OFF,
+    SYNTH_CMD_PATCH,
+    SYNTH_CMD_VOLUME,
+    SYNTH_CMD_FX,
+} synth_cmd_type_t;
+
+typedef struct synth_cmd {
+    uint8_t type;
+    uint8_t a;                  // String, or effect
+    uint8_t b;                  // Note
+    uint32_t posted_us;
+} synth_cmd_t;
+
+static amy_event e[NUM_STRINGS];
+
+// AMY internals (instrument.c, patches.c): the voices an instrument plays
+// on, and the first oscillator of each voice
+extern int instrument_get_voices(int instrument_number, uint16_t *voices);
+extern uint16_t voice_to_base_osc[];
+
+// Activity tracking, so the audio path can stop rendering when nothing sounds
+static bool string_held[NUM_STRINGS];
+static uint8_t string_note[NUM_STRINGS];
+static uint32_t string_release_ms[NUM_STRINGS];
+static uint16_t silent_blocks;
+
+#if SYNTH_MIDI_OUT
+/* MIDI helper function */
+static inline uint32_t tud_midi_write24 (uint8_t jack_id, uint8_t b1, uint8_t b2, uint8_t b3) {
+    // Use static array to avoid stack corruption when called from multiple contexts
+    // But ensure thread-safety by copying values immediately
+    uint8_t msg[3];
+    msg[0] = b1;
+    msg[1] = b2;
+    msg[2] = b3;
+    
+    // Validate MIDI note range before sending
+    if(b1 == MIDI_NOTE_ON || b1 == MIDI_NOTE_OFF) {  // Note on or note off
+        if(b2 > MIDI_NOTE_MAX) {
+            // Invalid note - don't send
+            return 0;
+        }
+    }
+    
+    return tud_midi_stream_write(jack_id, msg, 3);
+}
+#endif
+
+/* Engine side, runs on whichever core owns AMY */
+
+static void apply_note_on(uint8_t string, uint8_t note) {
+    e[string] = amy_default_event();
+    e[string].time = 0;
+    e[string].synth = string;  // Each string is its own instrument
+    e[string].midi_note = note;
+    e[string].velocity = NOTE_VELOCITY;
+    amy_add_event(&e[string]);
+    
+    string_held[string] = true;
+    string_note[string] = note;
+    silent_blocks = 0;
+}
+
+static void apply_note_off(uint8_t string, uint8_t note) {
+    e[string] = amy_default_event();
+    e[string].time = 0;
+    e[string].synth = string;
+    e[string].midi_note = note;
+    e[string].velocity = 0;  // velocity = 0 means note off
+    amy_add_event(&e[string]);
+    
+    // A note off for a note that was already replaced doesn't end the string
+    if (string_held[string] && string_note[string] == note) {
+        string_held[string] = false;
+        string_release_ms[string] = amy_sysclock();
+    }
+}
+
+static void apply_patch(void) {
+    uint16_t patch_num = get_patch();
+    
+    // Set up each string as its own instrument
+    for(uint8_t i = 0; i < NUM_STRINGS; i++) {
+        // Create an event to load the patch for this string/instrument
+        e[i] = amy_default_event();
+        e[i].time = 0;
+        e[i].synth = i;                 // Each string is instrument 0, 1, 2, 3
+        e[i].patch_number = patch_num;  // Load the selected patch
+        e[i].num_voices = 1;            // Just one voice per string
+        amy_add_event(&e[i]);
+    }
+}
+
+static void apply_volume(void) {
+    // Convert UI volume (0-8) to AMY volume (0-11.0 float)
+    uint8_t ui_volume = get_volume();
+    float amy_volume;
+    
+    if (ui_volume == 0) {
+        amy_volume = 0.0f;
+    } else {
+        amy_volume = ((float)ui_volume / 8.0f) * 11.0f;
+    }
+        
+    // Set AMY global volume directly
+    amy_global.volume = amy_volume;
+}
+
+static void apply_fx(amy_fx_t fx) {
+    switch(fx){
+        case REVERB:
+            config_reverb((float)get_fx(REVERB)*2.0f, get_reverb_liveness(), get_reverb_damping(), get_reverb_xover_hz());
+        break;
+        case CHORUS:
+            config_chorus((float)get_fx(CHORUS)*2.0f, get_chorus_max_delay(), get_chorus_lfo_freq(), get_chorus_depth());
+        break;
+        case ECHO:
+        {
+            // Ensure AMY is running and echo feature is enabled before configuring echo
+            if (!amy_global.running || !AMY_HAS_ECHO) {
+                break;
+            }
+            
+            float level = (float)get_fx(ECHO)*2.0f;
+            
+            config_echo(level, get_echo_delay_ms(), DIAPASONIX_ECHO_DEFAULT_MAX_DELAY_MS, get_echo_feedback(), get_echo_filter_coef());
+        }
+        break;
+        case FILTER:
+        {
+            bool enabled = get_fx(FILTER);
+            global_filter_set_enabled(enabled);
+            global_filter_set_per_string(get_filter_per_string());
+            if (enabled) {
+                static const float wah_attack_ms[FILTER_WAH_SPEED_COUNT] = {
+                    DIAPASONIX_FILTER_WAH_FAST_ATTACK_MS, DIAPASONIX_FILTER_WAH_MEDIUM_ATTACK_MS, DIAPASONIX_FILTER_WAH_SLOW_ATTACK_MS};
+                static const float wah_release_ms[FILTER_WAH_SPEED_COUNT] = {
+                    DIAPASONIX_FILTER_WAH_FAST_RELEASE_MS, DIAPASONIX_FILTER_WAH_MEDIUM_RELEASE_MS, DIAPASONIX_FILTER_WAH_SLOW_RELEASE_MS};
+                uint8_t speed = get_filter_wah_speed();
+                config_global_filter(get_filter_type(), get_filter_freq_hz(), get_filter_resonance());
+                config_global_filter_envelope(get_filter_wah_depth() * 0.5f, wah_attack_ms[speed], wah_release_ms[speed]);
+            }
+        }
+        break;
+        case DISTORTION:
+        {
+            bool enabled = get_fx(DISTORTION);
+            global_distortion_set_enabled(enabled);
+            global_distortion_set_oversampling(get_distortion_oversampling());
+            global_distortion_set_per_string(get_distortion_per_string());
+            if (enabled) {
+                config_global_distortion(get_distortion_model(), get_distortion_level(), get_distortion_gain());
+            }
+            fx_chain_set_order(get_fx_order());
+        }
+        break;
+    }
+}
+
+/* Commands */
+
+static void synth_apply(const synth_cmd_t *cmd) {
+    switch (cmd->type) {
+        case SYNTH_CMD_NOTE_ON:  apply_note_on(cmd->a, cmd->b); break;
+        case SYNTH_CMD_NOTE_OFF: apply_note_off(cmd->a, cmd->b); break;
+        case SYNTH_CMD_PATCH:    apply_patch(); break;
+        case SYNTH_CMD_VOLUME:   apply_volume(); break;
+        case SYNTH_CMD_FX:       apply_fx((amy_fx_t)cmd->a); break;
+    }
+}
+
+#if AUDIO_CORE1_ENGINE
+// Core1 owns AMY and the global effects, Core0 hands it commands through
+// a single-producer/single-consumer ring. Core0 only advances the head,
+// Core1 only advances the tail.
+static synth_cmd_t cmd_queue[SYNTH_CMD_QUEUE_SIZE];
+static _Atomic uint32_t cmd_head;
+static _Atomic uint32_t cmd_tail;
+static synth_cmd_stats_t cmd_stats;
+
+static void synth_dispatch(uint8_t type, uint8_t a, uint8_t b) {
+    uint32_t head = atomic_load_explicit(&cmd_head, memory_order_relaxed);
+    uint32_t wait_start = time_us_32();
+    
+    // Only full if Core1 is stalled, don't hang the UI waiting for it
+    while (head - atomic_load_explicit(&cmd_tail, memory_order_acquire) >= SYNTH_CMD_QUEUE_SIZE) {
+        if (time_us_32() - wait_start > SYNTH_CMD_POST_TIMEOUT_US) {
+            cmd_stats.dropped++;
+            return;
+        }
+        tight_loop_contents();
+    }
+    
+    cmd_queue[head % SYNTH_CMD_QUEUE_SIZE] = (synth_cmd_t){
+        .type = type, .a = a, .b = b, .posted_us = time_us_32(),
+    };
+    atomic_store_explicit(&cmd_head, head + 1, memory_order_release);
+    __sev();  // Wake Core1 if it sleeps waiting for an I2S buffer
+}
+
+void synth_process_commands(void) {
+    uint32_t tail = atomic_load_explicit(&cmd_tail, memory_order_relaxed);
+    uint32_t head = atomic_load_explicit(&cmd_head, memory_order_acquire);
+    
+    while (tail != head) {
+        const synth_cmd_t *cmd = &cmd_queue[tail % SYNTH_CMD_QUEUE_SIZE];
+        synth_apply(cmd);
+        
+        uint32_t latency_us = time_us_32() - cmd->posted_us;
+        if (latency_us > cmd_stats.max_latency_us) {
+            cmd_stats.max_latency_us = latency_us;
+        }
+        cmd_stats.processed++;
+        
+        tail++;
+        atomic_store_explicit(&cmd_tail, tail, memory_order_release);
+    }
+}
+
+void synth_get_cmd_stats(synth_cmd_stats_t *stats, bool reset) {
+    *stats = cmd_stats;
+    if (reset) {
+        cmd_stats = (synth_cmd_stats_t){0};
+    }
+}
+#else
+// Single audio owner on Core0: apply right away
+static void synth_dispatch(uint8_t type, uint8_t a, uint8_t b) {
+    synth_cmd_t cmd = {.type = type, .a = a, .b = b};
+    synth_apply(&cmd);
+}
+
+void synth_process_commands(void) {
+}
+
+void synth_get_cmd_stats(synth_cmd_stats_t *stats, bool reset) {
+    (void)reset;
+    *stats = (synth_cmd_stats_t){0};
+}
+#endif
+
+/* Note and audio */
+
+void note_on(uint8_t string, uint8_t note) {
+    // Validate string is within bounds
+    if(string >= NUM_STRINGS) {
+        return;  // Invalid string index
+    }
+    
+    // Validate note is within MIDI range
+    if(note > MIDI_NOTE_MAX) {
+        return;  // Invalid note
+    }
+    
+    synth_dispatch(SYNTH_CMD_NOTE_ON, string, note);
+    
+#if SYNTH_MIDI_OUT
+    // Send MIDI note on message (MIDI_NOTE_ON = note on, channel 0)
+    // Double-check note value before sending to MIDI
+    uint8_t midi_note = note;
+    if(midi_note > MIDI_NOTE_MAX) {
+        midi_note = MIDI_NOTE_MAX;  // Clamp to valid range
+    }
+    
+    uint8_t midi_velocity = (uint8_t)(NOTE_VELOCITY * MIDI_NOTE_MAX);
+    tud_midi_write24(0, MIDI_NOTE_ON, midi_note, midi_velocity);
+#endif
+}
+
+void note_off(uint8_t string, uint8_t note) {
+    if(string >= NUM_STRINGS) {
+        return;
+    }
+    
+    synth_dispatch(SYNTH_CMD_NOTE_OFF, string, note);
+    
+#if SYNTH_MIDI_OUT
+    // Send MIDI note off message (MIDI_NOTE_OFF = note off, channel 0)
+    tud_midi_write24(0, MIDI_NOTE_OFF, note, 0);
+#endif
+}
+
+void update_patch() {
+    synth_dispatch(SYNTH_CMD_PATCH, 0, 0);
+}
+
+void update_volume() {
+    synth_dispatch(SYNTH_CMD_VOLUME, 0, 0);
+}
+
+void update_fx(amy_fx_t fx) {
+    synth_dispatch(SYNTH_CMD_FX, (uint8_t)fx, 0);
+}
+
+/* Oscillators */
+
+// Each string has a single voice (see apply_patch()), and AMY gives every
+// voice a run of oscillators of its own. The runs are taken in the order of
+// their first oscillator, each reaching the next one, so that the strings
+// cover all of AMY's oscillators between them.
+bool synth_string_osc_ranges(uint16_t *start, uint16_t *end) {
+    uint16_t base[NUM_STRINGS];
+    for (uint8_t i = 0; i < NUM_STRINGS; i++) {
+        uint16_t voices[AMY_OSCS];
+        if (instrument_get_voices(i, voices) != 1 || voice_to_base_osc[voices[0]] >= AMY_OSCS) {
+            return false;  // Patch not loaded yet
+        }
+        base[i] = voice_to_base_osc[voices[0]];
+    }
+    for (uint8_t i = 0; i < NUM_STRINGS; i++) {
+        bool lowest = true;
+        end[i] = AMY_OSCS;
+        for (uint8_t j = 0; j < NUM_STRINGS; j++) {
+            if (j != i && base[j] == base[i]) {
+                return false;
+            }
+            if (base[j] < base[i]) lowest = false;
+            if (base[j] > base[i] && base[j] < end[i]) end[i] = base[j];
+        }
+        start[i] = lowest ? 0 : base[i];
+    }
+    return true;
+}
+
+/* Activity */
+
+static bool strings_idle(void) {
+    uint32_t now = amy_sysclock();
+    for (uint8_t i = 0; i < NUM_STRINGS; i++) {
+        if (string_held[i] || now - string_release_ms[i] < SYNTH_RELEASE_TAIL_MS) {
+            return false;
+        }
+    }
+    return true;
+}
+
+void synth_update_activity(const int16_t *block) {
+    if (!strings_idle()) {
+        silent_blocks = 0;
+        return;
+    }
+    
+    // Strings are done, wait for the effect tails (reverb, echo...) to decay too
+    if (block != NULL) {
+        for (uint16_t i = 0; i < AMY_BLOCK_SIZE * AMY_NCHANS; i++) {
+            if (block[i] > AUDIO_SILENCE_THRESHOLD || block[i] < -AUDIO_SILENCE_THRESHOLD) {
+                silent_blocks = 0;
+                return;
+            }
+        }
+    }
+    if (silent_blocks < AUDIO_IDLE_BLOCKS) {
+        silent_blocks++;
+    }
+}
+
+bool synth_is_silent(void) {
+    return silent_blocks >= AUDIO_IDLE_BLOCKS && strings_idle();
+}
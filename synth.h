@@ -0,0 +1,53 @@
+#ifndef SYNTH_H_
+#define SYNTH_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "amy.h"
+#include "state_data.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Bridge between the instrument state and the AMY engine.
+ * Shared by the firmware and the host render harness.
+ */
+
+void note_on(uint8_t string, uint8_t note);
+void note_off(uint8_t string, uint8_t note);
+
+// Apply the current state_data settings to the engine
+void update_patch(void);
+void update_volume(void);
+void update_fx(amy_fx_t fx);
+
+typedef struct synth_cmd_stats {
+    uint32_t processed;         // Commands applied by the engine
+    uint32_t dropped;           // Commands lost because the queue stayed full
+    uint32_t max_latency_us;    // Longest time between posting and applying a command
+} synth_cmd_stats_t;
+
+// With AUDIO_CORE1_ENGINE, the calls above only queue a command for the core
+// that owns AMY, which must call this before rendering each block.
+// Otherwise commands are applied right away and this does nothing.
+void synth_process_commands(void);
+void synth_get_cmd_stats(synth_cmd_stats_t *stats, bool reset);
+
+// Oscillators [start[s], end[s]) of each string s, together all of AMY's.
+// False if the strings don't have their voice yet. Call on the core that owns AMY.
+bool synth_string_osc_ranges(uint16_t *start, uint16_t *end);
+
+// Feed the mixed output of each block (NULL if AMY produced none), while rendering
+void synth_update_activity(const int16_t *block);
+
+// True when no string has sounded for SYNTH_RELEASE_TAIL_MS and the output has
+// stayed below AUDIO_SILENCE_THRESHOLD for AUDIO_IDLE_BLOCKS blocks.
+// Rendering can then be skipped until the next note_on().
+bool synth_is_silent(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* SYNTH_H_ */